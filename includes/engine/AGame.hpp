@@ -5,6 +5,7 @@
 #include "engine/Entity.hpp"
 #include "engine/GUI/GUI.hpp"
 #include "engine/GameRenderer.hpp"
+#include "engine/LayerMask.hpp"
 #include "engine/Light.hpp"
 #include "engine/Skybox.hpp"
 
@@ -37,6 +38,8 @@ class AGame {
 	virtual int getFirstSceneIdx(void) const = 0;
 	virtual int getStartingMusicVolume(void) const;
 	virtual int getStartingSoundsVolume(void) const;
+	virtual float getTickRate(void) const;
+	virtual RenderQuality getRenderQuality(void) const;
 
 	std::vector<std::tuple<float, std::string, std::string>> &getNeededFont();
 	std::vector<Entity *> const getEntities() const;
@@ -48,7 +51,8 @@ class AGame {
 	Camera *getLoadingCamera() const;
 	Light *getLoadingLight() const;
 	Skybox *getLoadingSkybox() const;
-	std::vector<std::vector<bool>> const &getCollisionTable(void);
+	std::vector<LayerMask> const &getCollisionMasks(void) const;
+	std::map<std::string, ModelInfo> const &getAllAssets(void) const;
 
 	void unload(void);
 	void setGameRenderer(GameRenderer *gameRenderer);
@@ -76,8 +80,9 @@ class AGame {
 	std::set<std::string> _neededAssets;
 	std::map<std::string, std::string> _allSounds;
 	std::set<std::string> _neededSounds;
-	std::vector<std::vector<bool>> _collisionTable;
+	std::vector<LayerMask> _collisionMasks;
 
+	void setCollisionMasks(LayerMask const *masks, size_t layerCount);
 	void setLayerCollision(int layer1, int layer2, bool doCollide);
 	void loadAssets(void);
 	void loadSounds(void);
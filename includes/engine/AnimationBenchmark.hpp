@@ -0,0 +1,77 @@
+#pragma once
+
+#include "engine/AnimationSystem.hpp"
+#include "engine/PoseBatch.hpp"
+
+// Seconds spent on each clip and sampling mode
+#define ANIMATION_BENCHMARK_DURATION 1.0
+// Entities sharing the model, each one starting at another time
+#define ANIMATION_BENCHMARK_ENTITIES 100
+// Playback time step, one frame at 60 fps
+#define ANIMATION_BENCHMARK_STEP (1.0f / 60.0f)
+// Times drawn upfront for the random mode
+#define ANIMATION_BENCHMARK_RANDOM_TIMES 4096
+// Largest palette element difference accepted between two sampling paths
+#define ANIMATION_BENCHMARK_MAX_ERROR 1e-3f
+// Steps played forward when checking the cursors, two seconds at 60 fps
+#define ANIMATION_BENCHMARK_CHECK_STEPS 120
+// Largest number of lanes of the kernels check, smaller counts cover every
+// remainder of the SSE blocks
+#define ANIMATION_BENCHMARK_CHECK_LANES 1001
+// Entities animated by the AnimationSystem when measuring its scaling
+#define ANIMATION_BENCHMARK_SCALING_ENTITIES 1000
+
+struct ModelInfo;
+
+enum BenchmarkMode {
+	BenchmarkForward = 0,  // Scalar, keys found from the cursors
+	BenchmarkRandom,       // Scalar, keys binary searched
+	BenchmarkBatched,      // PoseBatch kernels, played forward
+	BenchmarkModeCount
+};
+
+// Pose sampling throughput of one model, no window nor GL context needed
+// (see "--bench-animation" in main.cpp)
+class AnimationBenchmark final {
+   public:
+	AnimationBenchmark(ModelInfo const &modelInfo);
+	~AnimationBenchmark(void);
+
+	// Print for each clip the joints sampled per second and entities
+	// animated per millisecond of every mode, along with the largest
+	// difference between the batched palettes and the scalar ones, then
+	// the AnimationSystem throughput from 1 to one thread per core.
+	// Returns false when poses played forward from the key cursors differ
+	// from poses whose keys are searched from scratch, or batched palettes
+	// from the scalar ones (with the SSE and the scalar kernels).
+	bool run(size_t entityCount = ANIMATION_BENCHMARK_ENTITIES);
+	// Compare every kernel, SSE and scalar, with the glm interpolations on
+	// random keys for 1 to ANIMATION_BENCHMARK_CHECK_LANES lanes, no asset
+	// needed (see "--check-animation" in main.cpp)
+	static bool checkKernels(void);
+
+   private:
+	AnimationBenchmark(void);
+	AnimationBenchmark(AnimationBenchmark const &src);
+
+	AnimationBenchmark &operator=(AnimationBenchmark const &rhs);
+
+	void _bindPoses(std::string animName, std::vector<Pose> &poses,
+					std::vector<double> &times) const;
+	double _measure(std::string const &animName, size_t entityCount,
+					BenchmarkMode mode);
+	float _getBatchError(std::string const &animName, size_t entityCount,
+						 PoseBatch &batch);
+	float _getCursorError(std::string const &animName, size_t entityCount);
+	static float _getPaletteError(Pose const &expected, Pose const &actual);
+	static float _getKernelsError(size_t laneCount, bool useSSE);
+	static float _getRandom(float min, float max);
+	// Entities animated per millisecond with that many threads
+	double _measureThreads(std::string const &animName, size_t threadCount);
+	void _printScaling(std::string const &animName);
+
+	std::string _modelPath;
+	Model *_model;
+	PoseBatch _batch;
+	PoseBatch _scalarBatch;
+};
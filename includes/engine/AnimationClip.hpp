@@ -0,0 +1,63 @@
+#pragma once
+
+#include <assimp/scene.h>
+
+#include "engine/AnimationKernels.hpp"
+
+enum TrackKind { TrackPosition = 0, TrackRotation, TrackScaling, TrackCount };
+
+// Keys of one kind for every joint of a clip, the track of a joint is a
+// contiguous range of the arrays
+template <typename T>
+struct KeyArrays {
+	std::vector<float> times;
+	std::vector<T> values;
+	std::vector<unsigned int> firsts;  // Per joint, first key of its track
+	std::vector<unsigned int> counts;  // Per joint, 0 when not animated
+};
+
+// One animation compiled at load for the joints of a model. Models address
+// their clips by index, a name is only resolved when an entity switches to
+// another animation.
+class AnimationClip final {
+   public:
+	AnimationClip(double duration, size_t jointCount);
+	~AnimationClip(void);
+
+	double getDuration(void) const;
+	size_t getJointCount(void) const;
+	void setTrack(size_t jointIdx, aiNodeAnim const *nodeAnim);
+	bool hasTrack(size_t jointIdx) const;
+	// Local transform of a joint at the given time. Cursors are the last key
+	// used by each track of the joint (TrackCount values): playing forward
+	// they only move to the next key, other times are binary searched.
+	glm::mat4 sample(size_t jointIdx, float time, unsigned int *cursors) const;
+	// Push the keys around the given time of each track of a joint in the
+	// lanes of its kind (one per TrackKind), for the batched kernels
+	void gatherKeys(size_t jointIdx, float time, unsigned int *cursors,
+					KeyLanes *const *lanes) const;
+	// Same for a joint without any track
+	static void gatherIdentity(KeyLanes *const *lanes);
+
+   private:
+	AnimationClip(void);
+	AnimationClip(AnimationClip const &src);
+
+	AnimationClip &operator=(AnimationClip const &rhs);
+
+	// Index of the key starting the segment holding time, between 0 and
+	// count - 2, with the interpolation ratio in this segment
+	static unsigned int _findKey(float const *times, unsigned int count,
+								 float time, unsigned int &cursor,
+								 float &ratio);
+	template <typename T>
+	static void _gatherTrack(KeyArrays<T> const &arrays, size_t jointIdx,
+							 float time, unsigned int &cursor,
+							 T const &defaultValue, KeyLanes &lanes);
+
+	double _duration;
+	size_t _jointCount;
+	KeyArrays<glm::vec3> _positions;
+	KeyArrays<glm::quat> _rotations;
+	KeyArrays<glm::vec3> _scalings;
+};
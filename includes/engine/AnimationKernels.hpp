@@ -0,0 +1,62 @@
+#pragma once
+
+#include "engine/Engine.hpp"
+
+// Kernels handle 4 lanes per instruction when the compiler targets SSE
+// (always the case on x86-64), other targets use the scalar loops. Passing
+// useSSE as false runs the scalar loops anyway, to check one against the
+// other.
+#if defined(__SSE2__)
+#define ANIMATION_KERNELS_SSE 1
+#else
+#define ANIMATION_KERNELS_SSE 0
+#endif
+
+// Rows of an affine transform, the last row (0, 0, 0, 1) is implied
+struct Affine {
+	float rows[3][4];
+};
+
+// Keys surrounding the sampled time of many tracks, in struct of arrays so
+// that kernels interpolate several tracks at once. Lanes of constant tracks
+// have the same from and to values.
+class KeyLanes final {
+   public:
+	KeyLanes(size_t width);  // 3 for vectors, 4 for quaternions (x, y, z, w)
+	~KeyLanes(void);
+
+	void clear(void);
+	void push(float ratio, float const *from, float const *to);
+	size_t size(void) const;
+	size_t getWidth(void) const;
+
+	std::vector<float> ratios;
+	std::vector<float> from[4];
+	std::vector<float> to[4];
+
+   private:
+	KeyLanes(void);
+	KeyLanes(KeyLanes const &src);
+
+	KeyLanes &operator=(KeyLanes const &rhs);
+
+	size_t _width;
+};
+
+// Linear interpolation of every lane, out has one array per component
+void lerpLanes(KeyLanes const &lanes, std::vector<float> *out,
+			   bool useSSE = true);
+// Shortest path normalized lerp of quaternion lanes, its ratio corrected
+// by a polynomial of the keys angle to follow a slerp without acos and sin
+// (within 1e-3 on each matrix element for any angle)
+void nlerpLanes(KeyLanes const &lanes, std::vector<float> *out,
+				bool useSSE = true);
+// Translation * rotation * scale of each lane
+void composeAffines(std::vector<float> const *translations,
+					std::vector<float> const *rotations,
+					std::vector<float> const *scalings, size_t count,
+					Affine *out, bool useSSE = true);
+void multiplyAffines(Affine const &lhs, Affine const &rhs, Affine &out,
+					 bool useSSE = true);
+Affine toAffine(glm::mat4 const &matrix);
+glm::mat4 toMat4(Affine const &affine);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "engine/PoseBatch.hpp"
+#include "engine/ThreadPool.hpp"
+
+// Below this, entities are not worth another task
+#define ANIMATION_MIN_ENTITIES_PER_TASK 8
+
+// Poses of every entity animated this frame, sampled by a thread pool
+// before the render passes. Entities are split in one PoseBatch per task,
+// each one writing the palettes of its own entities only, so the GL thread
+// only has to upload them once sample() returns.
+class AnimationSystem final {
+   public:
+	AnimationSystem(size_t threadCount = 0);  // 0 for the hardware threads
+	~AnimationSystem(void);
+
+	void clear(void);
+	void add(Model const *model, Pose *pose, double animTime);
+	void sample(void);
+	size_t getThreadCount(void) const;
+
+   private:
+	struct Entry {
+		Model const *model;
+		Pose *pose;
+		double animTime;
+	};
+
+	AnimationSystem(AnimationSystem const &src);
+
+	AnimationSystem &operator=(AnimationSystem const &rhs);
+
+	ThreadPool _threadPool;
+	std::vector<Entry> _entries;
+	std::vector<PoseBatch *> _batches;  // One per thread
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "engine/GameEngine.hpp"
+
+// Ticks simulated when none are given
+#define BROADPHASE_BENCHMARK_TICKS 600
+
+// Collision candidates of the spatial grids against a scan of every entity,
+// measured on each tick of a headless scene (see "--bench-broadphase" in
+// main.cpp)
+class BroadphaseBenchmark final {
+   public:
+	BroadphaseBenchmark(GameEngine &gameEngine);
+	~BroadphaseBenchmark(void);
+
+	// Run the engine tick by tick, querying both broadphases for every
+	// collider of the scene after each tick. Prints the average pairs and
+	// time per tick of each one, returns false if they found other
+	// candidates.
+	bool run(size_t tickCount = BROADPHASE_BENCHMARK_TICKS);
+
+   private:
+	BroadphaseBenchmark(void);
+	BroadphaseBenchmark(BroadphaseBenchmark const &src);
+
+	BroadphaseBenchmark &operator=(BroadphaseBenchmark const &rhs);
+
+	void _measure(void);
+
+	GameEngine &_gameEngine;
+	size_t _entityCount = 0;  // Colliders queried, summed over the ticks
+	size_t _gridPairs = 0;
+	size_t _linearPairs = 0;
+	size_t _mismatches = 0;
+	double _gridTime = 0.0;  // In milliseconds
+	double _linearTime = 0.0;
+	std::vector<Entity *> _collisions[2];  // Grid then linear candidates
+	std::vector<Entity *> _triggers[2];
+};
@@ -10,6 +10,7 @@ class Camera : public Entity {
 	virtual ~Camera(void);
 
 	glm::mat4 const &getViewMatrix(void) const;
+	glm::mat4 getInterpolatedViewMatrix(float alpha) const;
 	glm::mat4 const &getProjectionMatrix(void) const;
 	int getNewSceneIdx(void) const;
 	std::string getNewSceneName(void) const;
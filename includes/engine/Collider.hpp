@@ -8,7 +8,7 @@ struct Collider final {
 	enum Shape { Rectangle = 0, Circle };
 	Collider(void);
 	Collider(Shape shape, int layerTag, float width, float height,
-			 bool isTrigger = false);
+			 bool isTrigger = false, bool isStatic = false);
 	~Collider(void);
 
 	Shape shape;
@@ -16,6 +16,7 @@ struct Collider final {
 	float width;
 	float height;
 	bool isTrigger;
+	bool isStatic;  // Never moves, grid aligned ones go in the tile layer
 
    private:
 	Collider(Collider const &src);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "engine/Engine.hpp"
+
+// Unordered pair of entity ids, always stored with first < second
+struct CollisionPair {
+	size_t first;
+	size_t second;
+
+	CollisionPair(size_t idA, size_t idB);
+
+	bool operator==(CollisionPair const &rhs) const;
+};
+
+struct CollisionPairHash {
+	size_t operator()(CollisionPair const &pair) const;
+};
+
+// Dense set of entity pairs with O(1) insertion, lookup and removal, each
+// entity keeping the slots of its pairs so that its death only visits them
+class CollisionPairSet final {
+   public:
+	CollisionPairSet(void);
+	~CollisionPairSet(void);
+
+	void insert(size_t idA, size_t idB);
+	bool contains(size_t idA, size_t idB) const;
+	void erase(size_t idA, size_t idB);
+	// Remove every pair the given entity is part of, O(pairs of that entity)
+	void eraseAll(size_t id);
+	void clear(void);
+	bool empty(void) const;
+	size_t size(void) const;
+	// Erasing the pair at idx only moves the last pair, so iterate backward
+	CollisionPair const &operator[](size_t idx) const;
+
+   private:
+	// Position of a pair slot in the lists of its first and second ids
+	struct PairLinks {
+		size_t first;
+		size_t second;
+	};
+
+	CollisionPairSet(CollisionPairSet const &src);
+
+	CollisionPairSet &operator=(CollisionPairSet const &rhs);
+
+	void _eraseAt(size_t idx);
+	void _unlink(size_t id, size_t link);
+	size_t &_getLink(size_t slot, size_t id);
+
+	std::vector<CollisionPair> _pairs;
+	std::vector<PairLinks> _links;  // Same order as _pairs
+	std::unordered_map<CollisionPair, size_t, CollisionPairHash> _indices;
+	// Slots in _pairs of the pairs of each entity id
+	std::unordered_map<size_t, std::vector<size_t>> _entityPairs;
+};
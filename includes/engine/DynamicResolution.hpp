@@ -0,0 +1,49 @@
+#pragma once
+
+#include "engine/Engine.hpp"
+
+// Queries in flight, results are read a few frames later without stalling
+#define DYNAMIC_RESOLUTION_QUERIES 4
+// GPU budget in ms for the 3D passes
+#define DYNAMIC_RESOLUTION_TARGET 12.0f
+// Scale is raised back once under this part of the budget
+#define DYNAMIC_RESOLUTION_HEADROOM 0.8f
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_STEP 0.05f
+// Measured frames between two changes of the scale
+#define DYNAMIC_RESOLUTION_COOLDOWN 15
+
+// Scale of the 3D scene driven by its GPU time, measured with timer queries
+class DynamicResolution final {
+   public:
+	DynamicResolution(void);
+	~DynamicResolution(void);
+
+	// Both need a current GL context
+	void init(void);
+	void release(void);
+	// Start again from the given scale, which is also the highest one used
+	void reset(float maxScale, bool isEnabled);
+	void beginFrame(void);
+	void endFrame(void);
+	float getScale(void) const;
+	float getGPUTime(void) const;  // Smoothed, in ms
+
+   private:
+	DynamicResolution(DynamicResolution const &src);
+
+	DynamicResolution &operator=(DynamicResolution const &rhs);
+
+	void _readResults(void);
+	void _adjustScale(void);
+
+	GLuint _queries[DYNAMIC_RESOLUTION_QUERIES] = {0};
+	bool _isPending[DYNAMIC_RESOLUTION_QUERIES] = {false};
+	size_t _current = 0;
+	bool _isMeasuring = false;
+	bool _isEnabled = false;
+	float _maxScale = 1.0f;
+	float _scale = 1.0f;
+	float _gpuTime = 0.0f;
+	size_t _cooldown = 0;
+};
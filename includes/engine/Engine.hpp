@@ -167,4 +167,20 @@ struct Vertex {
 	glm::vec2 texCoords = glm::vec2(0.0f);
 	glm::ivec4 jointIds = glm::ivec4(-1);
 	glm::vec4 weights = glm::vec4(0.0f);
+};
+
+// Per instance attributes, streamed once per draw batch
+struct InstanceData {
+	glm::mat4 model;
+	glm::vec3 color;  // Tint mixed with the material, -1 when none
+};
+
+// Renderer settings of a quality tier
+struct RenderQuality {
+	int shadowSize;          // Width and height of the shadow maps
+	int shadowCascades;      // 1 to MAX_SHADOW_CASCADES
+	int pcfRadius;           // Shadow map taps in a (2r+1)^2 kernel
+	int msaaSamples;         // 0 disables multisampling
+	float renderScale;       // 3D scene resolution relative to the window
+	bool dynamicResolution;  // Lower renderScale when the GPU falls behind
 };
\ No newline at end of file
@@ -22,10 +22,13 @@ class Entity {
 	bool loopAnim = true;
 	bool shouldBeAnimated = false;
 	float currentAnimSpeed = 1.0f;
+	Pose &getPose(void);  // Palette of the last frame this entity was drawn
 
 	GameEngine *getGameEngine(void) const;
 	const glm::vec3 &getPosition(void) const;
 	const glm::mat4 &getModelMatrix(void) const;
+	glm::vec3 getInterpolatedPosition(float alpha) const;
+	glm::mat4 getInterpolatedModelMatrix(float alpha) const;
 	const Collider *getCollider(void) const;
 	Model *getModel(void) const;
 	glm::vec3 const &getEulerAngles(void) const;
@@ -47,6 +50,7 @@ class Entity {
 	virtual void onTriggerEnter(Entity *entity);
 
 	void updateModel(void);
+	void savePreviousPosition(void);
 	void setColor(glm::vec3 const &color);
 	void resetColor(void);
 	void scale(glm::vec3 scale);
@@ -58,8 +62,10 @@ class Entity {
 
    private:
 	glm::vec3 _position;
+	glm::vec3 _previousPosition;  // Position at the start of current tick
 	glm::vec3 _eulerAngles;
 	glm::vec3 _color = glm::vec3(-1.0f);
+	Pose _pose;
 
 	glm::mat4 _scaleMatrix = glm::mat4(1.0f);
 	glm::mat4 _rotationMatrix;
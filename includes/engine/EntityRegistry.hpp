@@ -0,0 +1,48 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "engine/Entity.hpp"
+
+// Weak reference to an entity, resolves to nullptr once it is destroyed
+struct EntityHandle {
+	uint32_t index;
+	uint32_t generation;  // 0 is never given to a live entity
+
+	EntityHandle(void);
+	EntityHandle(uint32_t index, uint32_t generation);
+
+	bool isNull(void) const;
+	bool operator==(EntityHandle const &rhs) const;
+	bool operator!=(EntityHandle const &rhs) const;
+};
+
+// Slot map of the entities owned by the engine, with O(1) lookup by handle
+// or by entity id
+class EntityRegistry final {
+   public:
+	EntityRegistry(void);
+	~EntityRegistry(void);
+
+	EntityHandle add(Entity *entity);
+	void remove(Entity *entity);
+	void clear(void);
+	Entity *get(EntityHandle const &handle) const;
+	Entity *getById(size_t id) const;
+	EntityHandle getHandle(Entity *entity) const;
+	size_t size(void) const;
+
+   private:
+	struct Slot {
+		Entity *entity;
+		uint32_t generation;
+	};
+
+	EntityRegistry(EntityRegistry const &src);
+
+	EntityRegistry &operator=(EntityRegistry const &rhs);
+
+	std::vector<Slot> _slots;
+	std::vector<uint32_t> _freeSlots;
+	std::unordered_map<size_t, uint32_t> _slotsById;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "engine/Engine.hpp"
+
+// Local bounding volumes of a model
+struct Bounds {
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+};
+
+// Clipping planes of a view projection matrix, normals point inside
+class Frustum final {
+   public:
+	Frustum(glm::mat4 const &viewProjection);
+	~Frustum(void);
+
+	bool intersectsSphere(glm::vec3 const &center, float radius) const;
+	bool intersectsBox(glm::vec3 const &center,
+					   glm::vec3 const &halfExtents) const;
+	// Sphere test first, then the box transformed to world space
+	bool isVisible(Bounds const &bounds, glm::mat4 const &model) const;
+
+	// World space box holding the transformed local box
+	static void getWorldBox(Bounds const &bounds, glm::mat4 const &model,
+							glm::vec3 &center, glm::vec3 &halfExtents);
+
+   private:
+	Frustum(void);
+
+	glm::vec4 _planes[6];
+};
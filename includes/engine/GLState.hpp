@@ -0,0 +1,58 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "engine/Engine.hpp"
+
+// Texture units tracked by the cache, binds on other units are always issued
+#define GL_STATE_TEXTURE_UNITS 8
+#define GL_STATE_UNKNOWN 0xFFFFFFFF
+
+// Keeps the last OpenGL bindings and capabilities set through it to skip the
+// calls that would not change anything. Code changing them directly must
+// call invalidate() before using it again.
+class GLState final {
+   public:
+	GLState(void);
+	~GLState(void);
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertexArray);
+	void bindTexture(GLuint unit, GLenum target, GLuint texture);
+	void enable(GLenum capability);
+	void disable(GLenum capability);
+	void cullFace(GLenum mode);
+	void depthFunc(GLenum func);
+
+	void invalidate(void);
+	// State changes issued and skipped since the last reset
+	void resetCounters(void);
+	size_t getIssuedCount(void) const;
+	size_t getSkippedCount(void) const;
+
+   private:
+	enum TextureTarget {
+		Texture2D = 0,
+		Texture2DArray,
+		TextureCubeMap,
+		TextureTargetCount
+	};
+
+	GLState(GLState const &src);
+
+	GLState &operator=(GLState const &rhs);
+
+	bool _update(GLuint &cached, GLuint value);
+	void _setCapability(GLenum capability, bool isEnabled);
+	static int _getTargetIndex(GLenum target);
+
+	GLuint _program;
+	GLuint _vertexArray;
+	GLuint _activeUnit;
+	GLuint _textures[GL_STATE_TEXTURE_UNITS][TextureTargetCount];
+	GLuint _cullFaceMode;
+	GLuint _depthFunc;
+	std::unordered_map<GLenum, bool> _capabilities;
+	size_t _issuedCount = 0;
+	size_t _skippedCount = 0;
+};
@@ -4,31 +4,72 @@
 #include "engine/AudioManager.hpp"
 #include "engine/Camera.hpp"
 #include "engine/Collider.hpp"
+#include "engine/CollisionPairSet.hpp"
+#include "engine/EntityRegistry.hpp"
 #include "engine/Light.hpp"
+#include "engine/Profiler.hpp"
 #include "engine/Skybox.hpp"
+#include "engine/SpatialGrid.hpp"
+#include "engine/TileLayer.hpp"
 
 // For Threads
 #include <atomic>
 #include <thread>
 typedef std::chrono::high_resolution_clock Clock;
 
+// Distance kept between a mover and the tile or body it is blocked by
+#define CONTACT_GAP (2.0f * EPSILON)
+// Contacts resolved per move, each one slides the rest of the movement
+#define SWEEP_ITERATIONS 3
+
+// Past this many ticks in one frame the simulation slows down instead
+#define MAX_TICKS_PER_FRAME 5
+
 struct KeyState {
-	bool currFrame;
-	bool prevFrame;
+	bool currFrame = false;
+	bool prevFrame = false;
+	bool tickPressed = false;  // Pressed since the last tick ran
+};
+
+// Key event injected into the keyboard map right before a given tick
+struct ScriptedInput {
+	size_t tick;
+	int keyID;
+	bool isPressed;
 };
 
 class GameRenderer;
 
 class GameEngine final {
    public:
-	GameEngine(AGame *game);
+	GameEngine(AGame *game, bool headless = false);
 	~GameEngine(void);
 
 	void run();
 
+	// Simulation settings, mostly useful when running headless
+	bool setFirstScene(std::string const &sceneName);
+	void setFastForward(bool fastForward);
+	void setMaxTicks(size_t maxTicks);
+	void setInputScript(std::vector<ScriptedInput> const &inputScript);
+	static std::vector<ScriptedInput> loadInputScript(std::string const &path);
+	bool isHeadless(void) const;
+	size_t getTickCount(void) const;
+	Profiler &getProfiler(void);
+	// Broadphase of the current scene (see BroadphaseBenchmark): candidates
+	// of a collider from the grids or from a scan of every entity, returns
+	// how many entities were handed to the filters
+	std::vector<Entity *> const &getAllEntities(void) const;
+	size_t getCollisionCandidates(Entity *entity,
+								  std::vector<Entity *> &possibleCollisions,
+								  std::vector<Entity *> &possibleTriggers,
+								  bool linearScan);
+
 	// Functions needed by Renderer
 	GameRenderer const *getGameRenderer(void) const;
 	Entity *getEntityById(size_t id);
+	Entity *getEntity(EntityHandle const &handle) const;
+	EntityHandle getEntityHandle(Entity *entity) const;
 	// Entity *getFirstEntityWithName(std::string entityName);
 	// std::vector<Entity *> getEntitiesWithName(std::string entityName);
 	// Entity *getFirstEntityWithLabel(std::string entityLabel);
@@ -38,30 +79,21 @@ class GameEngine final {
 	// Function to change key game settings
 	void updateMusicVolume(int newValue);
 	void updateSoundsVolume(int newValue);
+	void setTickRate(float tickRate);
 
 	// Functions needed by entities
 	bool isKeyPressed(int keyID);
 	bool isKeyJustPressed(int keyID);
+	// Fixed tick duration while simulating, frame duration while rendering
 	float getDeltaTime();
+	float getTickRate(void) const;
+	float getInterpolationAlpha(void) const;
 	void addNewEntity(Entity *entity);
+	void tellPosition(Entity *entity);
 	void playMusic(std::string musicPath);
 	void playSound(std::string soundName);
 
    private:
-	struct LineInfo {  // Equation of a line: z = mx + q
-	   public:
-		LineInfo(void);
-		LineInfo(float startX, float startZ, float endX, float endZ);
-
-		float m;
-		float q;
-		bool isVertical;  // if line is vertical then m = inf
-		float startX;
-		float startZ;
-		float endX;
-		float endZ;
-	};
-
 	struct RectanglePoints {
 	   public:
 		float top;
@@ -77,6 +109,11 @@ class GameEngine final {
 
 	GameEngine &operator=(GameEngine const &rhs);
 
+	static int _parseKeyName(std::string const &keyName);
+
+	bool _runTick(int &newSceneIdx);
+	void _rollKeysOver(void);
+	void _applyInputScript(void);
 	bool _initScene(size_t newSceneIdx);
 	void _unloadScene(void);
 	void _loadScene(
@@ -84,29 +121,49 @@ class GameEngine final {
 		bool *_checkLoadSceneIsGood);  // function to call for background Thread
 
 	void _moveEntities(void);
+	void _registerCollider(Entity *entity);
+	void _unregisterCollider(Entity *entity);
 	void _getPossibleCollisions(Entity *entity,
 								std::vector<Entity *> &possibleCollisions,
 								std::vector<Entity *> &possibleTriggers,
-								std::vector<Entity *> &entitiesToTest);
-	size_t _checkCollision(Entity *entity, glm::vec3 &futureMovement,
-						   std::vector<Entity *> &collidedEntities);
-	void _getMovementLines(Entity *entity, glm::vec3 &targetMovement,
-						   LineInfo *lineA, LineInfo *lineB);
-	bool _hasCollisionCourse(LineInfo &lineA, LineInfo &lineB, int layerTag,
-							 Entity *entityB);
-	bool _isLineLineCollision(LineInfo &lineA, LineInfo &lineB);
-	bool _isLineCircleCollision(LineInfo &lineA, float &xSquareCoeff,
-								float &xCoeff, float &zSquareCoeff,
-								float &zCoeff, float &cCoeff);
+								bool withStaticTiles);
+	bool _canCollide(Entity *entity, Entity *entityToTest);
+	bool _isPossibleCollision(Entity *entity,
+							  RectanglePoints const &rectanglePoints,
+							  Entity *entityToTest);
+	void _moveAgainstTiles(Entity *entity, glm::vec3 &futureMovement,
+						   std::vector<Entity *> &blockingTiles,
+						   bool canSlide);
+	float _sweepTiles(Entity *entity, glm::vec3 const &position, bool alongX,
+					  float movement, std::vector<Entity *> &blockingTiles);
+	float _slideAroundTiles(Entity *entity, glm::vec3 const &position,
+							bool alongX, float maxSlide,
+							std::vector<Entity *> const &tilesToAvoid,
+							std::vector<Entity *> &blockingTiles);
+	void _getPossibleCollisionsLinear(Entity *entity,
+									  std::vector<Entity *> &possibleCollisions,
+									  std::vector<Entity *> &possibleTriggers,
+									  bool withStaticTiles);
+	void _sweepBodies(Entity *entity, glm::vec3 &futureMovement,
+					  std::vector<Entity *> const &bodies,
+					  std::vector<Entity *> &hitBodies);
+	bool _sweepShape(Entity *entity, glm::vec3 const &position,
+					 glm::vec3 const &movement, Entity *other, float gap,
+					 float &time, glm::vec3 &normal) const;
+	bool _sweepRoundedBox(glm::vec3 const &origin, glm::vec3 const &movement,
+						  float halfWidth, float halfHeight, float radius,
+						  float &time, glm::vec3 &normal) const;
+	bool _sweepBox(glm::vec3 const &origin, glm::vec3 const &movement,
+				   float halfWidth, float halfHeight, float &time,
+				   glm::vec3 &normal) const;
+	bool _sweepCircle(glm::vec3 const &origin, glm::vec3 const &movement,
+					  float radius, float &time, glm::vec3 &normal) const;
 	bool _doCollide(const Collider *colliderA, const glm::vec3 &posA,
 					Entity *entityB) const;
 	bool _collisionCircleRectangle(const Collider *circleCollider,
 								   const glm::vec3 &circlePos,
 								   const Collider *rectangleCollider,
 								   const glm::vec3 &rectanglePos) const;
-	bool _tryShortcut(Entity *entity, glm::vec3 &futureMovement,
-					  glm::vec3 &shortcutMovement, Entity *toAvoid,
-					  std::vector<Entity *> &possibleCollisionEntities);
 	void _setSceneVariables(void);
 	void _setLoadingSceneVariables(void);
 	void _setNewResolution();
@@ -117,6 +174,23 @@ class GameEngine final {
 	Clock::time_point _frameTs;
 	Clock::time_point _lastFrameTs;
 	double _deltaTime;
+	double _frameDeltaTime;
+
+	// Fixed timestep vars
+	float _tickRate = 60.0f;
+	float _interpolationAlpha = 1.0f;
+	size_t _tickCount = 0;
+	bool _isRunningTick = false;  // Which key presses isKeyJustPressed sees
+
+	// Headless simulation vars
+	bool _headless;
+	bool _fastForward = false;
+	size_t _maxTicks = 0;  // 0 means no limit
+	std::vector<ScriptedInput> _inputScript;
+	size_t _inputScriptIdx = 0;
+
+	// Per phase CPU timings, F3 shows the overlay and F4 dumps a CSV
+	Profiler _profiler;
 
 	// Thread
 	std::thread *_loadSceneThread = nullptr;
@@ -141,6 +215,16 @@ class GameEngine final {
 	std::vector<Entity *> _loadingAllEntities = std::vector<Entity *>();
 
 	std::vector<Entity *> _newEntities;
-	std::map<size_t, std::vector<size_t>> _initialCollisionMap;
-	std::vector<std::vector<bool>> const &_collisionTable;
+	std::vector<Entity *> _mergeCollisions;
+	std::vector<Entity *> _mergeTriggers;
+	// Every entity owned by the engine, spawned ones included
+	EntityRegistry _entityRegistry;
+	// Pairs overlapping since a spawn, ignored until they get apart
+	CollisionPairSet _initialCollisions;
+
+	// Collision broadphase, static tiles are kept apart from dynamic bodies
+	SpatialGrid _spatialGrid;
+	TileLayer _tileLayer;
+	std::vector<Entity *> _broadphaseCandidates;
+	std::vector<LayerMask> const &_collisionMasks;
 };
@@ -1,16 +1,38 @@
 #pragma once
 
+#include "engine/AnimationSystem.hpp"
 #include "engine/Camera.hpp"
 #include "engine/Collider.hpp"
+#include "engine/DynamicResolution.hpp"
+#include "engine/Frustum.hpp"
+#include "engine/GLState.hpp"
 #include "engine/Light.hpp"
 #include "engine/Model.hpp"
+#include "engine/RenderQueue.hpp"
 #include "engine/ShaderProgram.hpp"
+#include "engine/ShaderVariants.hpp"
+#include "engine/ShadowCascades.hpp"
 #include "engine/Skybox.hpp"
 
 #include "GUI/GUI.hpp"
 
-#define SHADOW_H 4096
-#define SHADOW_W 4096
+#include <unordered_set>
+
+// Light rotation in degrees after which static casters are drawn again
+#define SHADOW_CACHE_ANGLE 1.0f
+
+// std140 layout of the Frame block shared by all shaders
+struct FrameBlock {
+	glm::mat4 VP;
+	glm::mat4 lightSpaceMatrices[MAX_SHADOW_CASCADES];
+	glm::mat4 skyboxVP;  // Without the camera translation
+	glm::vec4 viewPos;
+	glm::vec4 lightDir;
+	glm::vec4 lightColor;
+	glm::vec4 cascadeSplits;  // View depth where each cascade ends
+	GLint cascadeCount;
+	GLint padding[3];  // Block size is rounded up to a vec4
+};
 
 class GameEngine;
 
@@ -22,7 +44,7 @@ struct ModelInfo;
 
 class GameRenderer final {
    public:
-	GameRenderer(GameEngine *gameEngine, AGame *game);
+	GameRenderer(GameEngine *gameEngine, AGame *game, bool headless = false);
 	~GameRenderer(void);
 
 	void getUserInput(void);
@@ -32,13 +54,17 @@ class GameRenderer final {
 	void setNewResolution(bool isFullScreen, int width, int height);
 	void loadAssets(std::map<std::string, ModelInfo> assets);
 	void initModelsMeshes(void);
+	// Rebuild the shadow maps and the scene target for a quality tier
+	void setRenderQuality(RenderQuality const &quality);
 
 	Model *getModel(std::string modelName) const;
 	int getWidth(void) const;
 	int getHeight(void) const;
 	glm::vec2 getMousePos(void) const;
 	GUI *getGUI();
+	GLState &getGLState(void);
 	GLFWwindow *getWindow(void) const;
+	bool isHeadless(void) const;
 
    private:
 	static void keyCallback(GLFWwindow *window, int key, int scancode,
@@ -54,8 +80,36 @@ class GameRenderer final {
 	void _initWindow(void);
 	void _initGUI(void);
 	bool _initDepthMap(void);
+	bool _initDepthTarget(GLuint *fbos, GLuint &texture);
 	void _initShader(void);
 	void _initModels(void);
+	void _initInstanceBuffer(void);
+	void _initFrameBuffer(void);
+	void _initSceneTarget(void);
+	void _deleteSceneTarget(void);
+	// Copy the scene to the window, scaled up to its size
+	void _presentScene(int sceneWidth, int sceneHeight);
+	// Items outside the camera or light frustum are left out of their pass,
+	// static casters are only queued when their shadows are refreshed
+	void _buildRenderQueue(std::vector<Entity *> &entities,
+						   glm::mat4 const &view,
+						   glm::mat4 const &viewProjection,
+						   bool refreshStaticShadows, float alpha);
+	bool _isStaticCaster(Entity *entity) const;
+	// Static casters hidden since the last refresh (flickering when damaged)
+	// are drawn with the moving ones instead of being cached
+	bool _isCachedCaster(Entity *entity) const;
+	// Advance the animations of shown entities and sample the poses of the
+	// queued ones, before any pass reads them
+	void _updatePoses(std::vector<Entity *> &entities);
+	// Check the static shadows refresh conditions and update the cascades
+	// fits on the scene bounds
+	bool _updateShadowCache(std::vector<Entity *> &entities, Light *light,
+							glm::mat4 const &view, glm::mat4 const &projection);
+	// Non rigged items outside of the frustum are skipped when one is given,
+	// each item is drawn with its own shader variant
+	void _submitPass(RenderPass pass, Frustum const *frustum = nullptr);
+	void _uploadInstances(InstanceData const *instances, size_t count);
 
 	static GameEngine *_gameEngine;
 	static glm::vec2 _mousePos;
@@ -63,6 +117,7 @@ class GameRenderer final {
 	// General vars
 	GLFWwindow *_window = nullptr;
 	AGame *_game = nullptr;
+	bool _headless;
 	bool _isFullScreen;
 	int _width;
 	int _height;
@@ -75,16 +130,50 @@ class GameRenderer final {
 	GUI *_graphicUI = nullptr;
 
 	// Rendering vars
-	ShaderProgram *_shaderProgram = nullptr;
-	ShaderProgram *_shadowShaderProgram = nullptr;
+	GLState _glState;
+	ShaderVariants *_shaderVariants = nullptr;  // Rigged and textured
+	ShaderVariants *_shadowShaderVariants = nullptr;  // Rigged only
 	ShaderProgram *_skyboxShaderProgram = nullptr;
 	std::map<std::string, Model *> _models = std::map<std::string, Model *>();
 	std::vector<std::string> _toDelete;  // Models to delete
 
-	// Shadow
-	GLuint _depthMapFBO;
-	GLuint _depthMap;
-
-	// Light
-	glm::mat4 _lightSpaceMatrix;
+	// Draw lists of both passes, items sharing a non rigged mesh are
+	// instanced
+	RenderQueue _renderQueue;
+	GLuint _instanceVBO = 0;
+	std::vector<InstanceData> _instances;
+	size_t _culledCounts[PassCount] = {0, 0, 0};  // Entities culled per pass
+	std::vector<Entity *> _posedEntities;  // Rigged entities in any pass
+	AnimationSystem _animationSystem;  // Samples them on every core
+
+	// Per frame uniforms, uploaded once for every program
+	GLuint _frameUBO = 0;
+
+	// Quality tier, the 3D scene is drawn offscreen at its render scale
+	RenderQuality _quality;
+	DynamicResolution _dynamicResolution;
+	GLuint _sceneFBO = 0;
+	GLuint _sceneBuffers[2] = {0, 0};  // Color and depth, multisampled
+	GLuint _resolveFBO = 0;            // MSAA only
+	GLuint _resolveBuffer = 0;
+	int _sceneWidth = 0;  // Size allocated for the highest scale
+	int _sceneHeight = 0;
+	bool _isSceneTargetValid = false;  // Window size or samples changed
+
+	// Shadow, texture arrays with one framebuffer per cascade layer
+	GLuint _depthMapFBOs[MAX_SHADOW_CASCADES] = {0};
+	GLuint _depthMap = 0;
+	GLuint _staticDepthMapFBOs[MAX_SHADOW_CASCADES] = {0};
+	GLuint _staticDepthMap = 0;  // Static casters only
+	size_t _cascadeCount = 1;
+	ShadowCascades _shadowCascades;
+	std::vector<Frustum> _cascadeFrustums;
+
+	// Light at the last static shadows refresh, used by both shadow passes
+	glm::mat4 _lightView;
+	glm::vec3 _lightDir;
+	bool _isShadowCacheValid = false;
+	size_t _staticCasterCount = 0;
+	size_t _staticCasterHash = 0;  // Of their ids and positions
+	std::unordered_set<size_t> _hiddenCasterIds;  // Left out of the cache
 };
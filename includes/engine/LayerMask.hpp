@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One bit per layer, a layer's mask holds every layer it collides with
+typedef uint32_t LayerMask;
+
+#define MAX_LAYERS 32
+#define ALL_LAYERS (~LayerMask(0))
+
+// Two layers that must not collide with each other
+struct LayerPair {
+	int layer1;
+	int layer2;
+};
+
+// Masks of a whole game, meant to be built at compile time
+template <size_t LayerCount>
+struct LayerCollisionTable {
+	LayerMask masks[LayerCount];
+};
+
+constexpr LayerMask layerBit(int layer) { return LayerMask(1) << layer; }
+
+constexpr LayerMask layersUpTo(size_t layerCount) {
+	return layerCount >= MAX_LAYERS ? ALL_LAYERS
+									: layerBit(layerCount) - LayerMask(1);
+}
+
+// Remove from mask every layer paired with the given one
+constexpr LayerMask layerCollisionMask(int layer, LayerPair const *pairs,
+									   size_t pairCount, LayerMask mask) {
+	return pairCount == 0
+			   ? mask
+			   : layerCollisionMask(
+					 layer, pairs + 1, pairCount - 1,
+					 pairs->layer1 == layer
+						 ? mask & ~layerBit(pairs->layer2)
+						 : pairs->layer2 == layer
+							   ? mask & ~layerBit(pairs->layer1)
+							   : mask);
+}
+
+// C++11 has no std::index_sequence, this one only lists layers
+template <size_t... Layers>
+struct LayerIndices {};
+
+template <size_t Count, size_t... Layers>
+struct MakeLayerIndices : MakeLayerIndices<Count - 1, Count - 1, Layers...> {};
+
+template <size_t... Layers>
+struct MakeLayerIndices<0, Layers...> {
+	typedef LayerIndices<Layers...> type;
+};
+
+template <size_t LayerCount, size_t PairCount, size_t... Layers>
+constexpr LayerCollisionTable<LayerCount> buildLayerCollisionTable(
+	LayerPair const (&pairs)[PairCount], LayerIndices<Layers...>) {
+	return LayerCollisionTable<LayerCount>{
+		{layerCollisionMask(static_cast<int>(Layers), pairs, PairCount,
+							layersUpTo(LayerCount))...}};
+}
+
+// Every layer collides with every other one except the listed pairs
+template <size_t LayerCount, size_t PairCount>
+constexpr LayerCollisionTable<LayerCount> buildLayerCollisionTable(
+	LayerPair const (&pairs)[PairCount]) {
+	static_assert(LayerCount <= MAX_LAYERS, "Too many collision layers");
+	return buildLayerCollisionTable<LayerCount>(
+		pairs, typename MakeLayerIndices<LayerCount>::type());
+}
@@ -12,7 +12,6 @@ class Light : public Entity {
 
 	glm::vec3 const &getDir(void) const;
 	glm::vec3 const &getColor(void) const;
-	glm::mat4 const &getProjectionMatrix(void) const;
 	glm::mat4 const &getViewMatrix(void) const;
 
    protected:
@@ -25,7 +24,6 @@ class Light : public Entity {
 
 	glm::vec3 _dir;
 	glm::vec3 _rotationAxis;
-	glm::mat4 _projection;
 	glm::mat4 _view;
 
 	Light(void);
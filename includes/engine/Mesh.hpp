@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/Engine.hpp"
+#include "engine/GLState.hpp"
 #include "engine/ShaderProgram.hpp"
 
 struct Material {
@@ -11,6 +12,16 @@ struct Material {
 	float shininess = 64;
 };
 
+// std140 layout of the Material block, see default.fs
+struct MaterialBlock {
+	glm::vec3 ambientColor;
+	float shininess;
+	glm::vec3 diffuseColor;
+	float padding0;  // Textures are a shader variant, see ShaderVariants
+	glm::vec3 specularColor;
+	float padding1;
+};
+
 struct TextureInfo {
 	unsigned char *data = nullptr;
 	int x;
@@ -25,19 +36,29 @@ class Mesh final {
 	virtual ~Mesh(void);
 
 	size_t getSize(void) const;
+	size_t getId(void) const;
+	GLuint getDiffuseTexture(void) const;  // 0 when there is none
 	void setupTexture(void);
-	void setupBuffers(void);
-	void draw(ShaderProgram const &shaderProgram, glm::vec3 const &color) const;
+	void setupBuffers(GLuint instanceVBO);
+	MaterialBlock getMaterialBlock(void) const;
+	// Range of the model material buffer bound before each draw
+	void setMaterialRange(GLuint materialUBO, GLintptr offset);
+	void draw(GLState &glState, GLsizei instanceCount) const;
 
-	GLuint VAO;
-	GLuint VBO;
+	GLuint VAO = 0;
+	GLuint VBO = 0;
 
    private:
+	static size_t _createdMeshes;
+
+	size_t _id;
 	size_t _size;
 	TextureInfo _textureInfo;
 	std::vector<Vertex> _vertices;
 	Material const _material;
 	GLuint _diffuseTexture;
+	GLuint _materialUBO = 0;
+	GLintptr _materialOffset = 0;
 
 	Mesh(void);
 	Mesh(Mesh const &src);
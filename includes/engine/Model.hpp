@@ -1,21 +1,63 @@
 #pragma once
 
+#include "engine/AnimationClip.hpp"
+#include "engine/Frustum.hpp"
 #include "engine/Joint.hpp"
 #include "engine/Mesh.hpp"
 
+// Size of the boneTransforms array in the shaders
+#define MAX_JOINTS 32
+// Room left around the bind pose of rigged models for animated limbs
+#define RIGGED_BOUNDS_MARGIN 1.25f
+
+class Model;
+
+// Joints palette of one entity, sampled at most once per frame and read by
+// every pass drawing it, along with its animation state
+struct Pose {
+	std::vector<glm::mat4> palette;
+	std::vector<glm::mat4> globals;     // Joints in skeleton order, scratch
+	std::vector<unsigned int> cursors;  // Last key of each joint track
+	Model const *model = nullptr;       // Owner of the bound clip
+	std::string animName;               // Name the clip was resolved from
+	int clipId = -1;                    // -1 for the bind pose
+	double sampledTime = -1.0;  // Negative until sampled with this clip
+};
+
 class Model final {
    public:
 	Model(std::string const &modelPath);
 	virtual ~Model(void);
 
-	std::vector<Mesh *> const getMeshes(void) const;
-	void initModel(void);
-	void draw(ShaderProgram const &shaderProgram,
-			  glm::vec3 const &color = glm::vec3(-1.0f));
+	std::vector<Mesh *> const &getMeshes(void) const;
+	void initModel(GLuint instanceVBO);
+	// Upload an entity palette before drawing meshes of this model with a
+	// rigged shader variant
+	void uploadPose(ShaderProgram const &shaderProgram, Pose const &pose) const;
 	Joint *findJointByName(std::string const &name);
-	void updateBoneTransforms(double *animTime, std::string &animName,
-							  bool loop, float deltaTime, float speed);
+	// Resolve the clip of an animation name when it changed, an unknown
+	// animation is replaced by 'Idle'
+	void bindClip(std::string &animName, Pose &pose) const;
+	// Move the animation time of the bound clip forward
+	void advanceAnimation(double *animTime, Pose const &pose, bool loop,
+						  float deltaTime, float speed) const;
+	// Fill the palette for the given time, kept as is when it was already
+	// sampled at that time. This is the scalar reference of PoseBatch.
+	void samplePose(double animTime, Pose &pose) const;
+	bool needsSampling(double animTime, Pose const &pose) const;
+	// Batched sampling, see PoseBatch: keys of each joint in skeleton order
+	// are pushed to the lanes, then the palette is composed from the local
+	// transforms the kernels computed from them
+	void gatherKeys(double animTime, Pose &pose, KeyLanes *const *lanes) const;
+	void composePalette(double animTime, Pose &pose, Affine const *locals,
+						Affine *globals, bool useSSE = true) const;
+	int getClipId(std::string const &animName) const;  // -1 when unknown
+	std::map<std::string, int> const &getClipIds(void) const;
+	AnimationClip const *getClip(int clipId) const;
+	size_t getJointCount(void) const;
 	bool isRigged(void) const;
+	// Local space volumes enclosing every vertex, used for culling
+	Bounds const &getBounds(void) const;
 	void addAnimation(std::string const &animName, std::string const &animPath);
 
    private:
@@ -23,10 +65,21 @@ class Model final {
 	std::string const _directory;
 
 	std::vector<Joint *> _joints;
+	// Joint indices sorted parents first, with the position of each parent
+	// in this order (-1 for roots)
+	std::vector<size_t> _skeletonOrder;
+	std::vector<int> _skeletonParents;
+	std::vector<Affine> _bindAffines;    // Per joint index, for PoseBatch
+	std::vector<Affine> _offsetAffines;  // Per joint index, for PoseBatch
 	unsigned int _jointIndex = 0;
 	bool _rigged = false;
 	bool _animated = false;
-	std::map<std::string, double> _animLengths;
+	std::vector<AnimationClip *> _clips;
+	std::map<std::string, int> _clipIds;
+	static glm::mat4 const _toYAxisUp;
+	GLuint _materialUBO = 0;  // Materials of all meshes
+	Bounds _bounds;
+	bool _hasBounds = false;
 
 	Model(void);
 	Model(Model const &src);
@@ -38,6 +91,10 @@ class Model final {
 							 Material &material);
 	static glm::mat4 toGlmMat4(const aiMatrix4x4 &src);
 	void _buildSkeletonHierarchy(aiNode *rootNode);
+	void _addClip(std::string const &animName, aiAnimation const *anim);
+	void _initMaterials(void);
+	void _extendBounds(glm::vec3 const &position);
+	void _computeBoundingSphere(void);
 
 	Model &operator=(Model const &rhs);
 };
\ No newline at end of file
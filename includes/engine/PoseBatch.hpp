@@ -0,0 +1,41 @@
+#pragma once
+
+#include "engine/AnimationKernels.hpp"
+#include "engine/Model.hpp"
+
+// Poses of many entities sampled together. Keys of every joint are first
+// gathered in lanes, then each kernel runs once over the joints of all the
+// entities before each skeleton is composed.
+class PoseBatch final {
+   public:
+	PoseBatch(bool useSSE = true);  // See AnimationKernels.hpp
+	~PoseBatch(void);
+
+	void clear(void);
+	// Poses already sampled at this time are left out
+	void add(Model const *model, Pose *pose, double animTime);
+	void sample(void);
+	size_t size(void) const;
+	size_t getJointCount(void) const;  // Of the last sample
+
+   private:
+	struct Entry {
+		Model const *model;
+		Pose *pose;
+		double animTime;
+		size_t firstLane;  // First joint in the lanes
+	};
+
+	PoseBatch(PoseBatch const &src);
+
+	PoseBatch &operator=(PoseBatch const &rhs);
+
+	bool _useSSE;
+	std::vector<Entry> _entries;
+	KeyLanes _translations;
+	KeyLanes _rotations;
+	KeyLanes _scalings;
+	std::vector<float> _results[TrackCount][4];  // Interpolated components
+	std::vector<Affine> _locals;
+	std::vector<Affine> _globals;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "engine/Engine.hpp"
+
+// Number of frames kept for percentiles and CSV export
+#define PROFILER_HISTORY 600
+
+enum ProfilerPhase {
+	PhaseInput = 0,
+	PhaseCamera,
+	PhaseEntities,
+	PhaseMerge,
+	PhaseMove,
+	PhaseDestroy,
+	PhaseInitialCollisions,
+	PhaseAnimation,
+	PhaseShadow,
+	PhaseMain,
+	PhaseGUI,
+	PhaseCount
+};
+
+// Per frame totals recorded along with the phase times
+enum ProfilerCounter {
+	CounterStateIssued = 0,
+	CounterStateSkipped,
+	CounterCulledShadow,
+	CounterCulledLit,
+	CounterGPUTime,      // 3D passes, in microseconds
+	CounterRenderScale,  // Percent of the window resolution
+	CounterCount
+};
+
+class GUI;
+
+// CPU time spent in each phase of the game loop, sampled per frame
+class Profiler final {
+   public:
+	Profiler(size_t history = PROFILER_HISTORY);
+	~Profiler(void);
+
+	void beginFrame(void);
+	void endFrame(void);
+	// Phases may run several times per frame (one per tick), times add up
+	void start(ProfilerPhase phase);
+	void stop(ProfilerPhase phase);
+	void setCounter(ProfilerCounter counter, size_t value);
+
+	// Percentiles in milliseconds over the recorded frames, phase may be
+	// PhaseCount for the whole frame
+	float getPercentile(ProfilerPhase phase, float percent) const;
+	float getCounterPercentile(ProfilerCounter counter, float percent) const;
+	size_t getSampleCount(void) const;
+	bool isOverlayVisible(void) const;
+	void toggleOverlay(void);
+	void drawGUI(GUI *graphicUI, int windowWidth) const;
+	bool dumpCSV(std::string const &path) const;
+
+	static const char *getPhaseName(ProfilerPhase phase);
+	static const char *getCounterName(ProfilerCounter counter);
+
+   private:
+	typedef std::chrono::high_resolution_clock ProfilerClock;
+
+	struct Sample {
+		size_t frame;
+		float phases[PhaseCount + 1];  // Last one is the whole frame, in ms
+		size_t counters[CounterCount];
+	};
+
+	Profiler(Profiler const &src);
+
+	Profiler &operator=(Profiler const &rhs);
+
+	Sample const &_getSample(size_t idx) const;  // 0 is the oldest one
+	static float _getPercentile(std::vector<float> &values, float percent);
+
+	std::vector<Sample> _samples;
+	size_t _nextSample = 0;
+	size_t _sampleCount = 0;
+	size_t _frameCount = 0;
+	bool _isOverlayVisible = false;
+	Sample _current;
+	ProfilerClock::time_point _frameStart;
+	ProfilerClock::time_point _phaseStarts[PhaseCount];
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "engine/Engine.hpp"
+#include "engine/ShaderVariants.hpp"
+
+// Depth range sorted front to back in the keys, farther items share the
+// last value
+#define RENDER_QUEUE_MAX_DEPTH 100.0f
+
+class Entity;
+class Model;
+class Mesh;
+
+// Static casters have their own shadow pass, cached between light moves
+enum RenderPass { PassStaticShadow = 0, PassShadow, PassLit, PassCount };
+
+struct DrawItem {
+	uint64_t key;
+	ShaderProgram *program;  // Variant picked for the mesh features
+	Entity *entity;  // Rigged models are posed from it
+	Model *model;
+	Mesh *mesh;
+	InstanceData instance;
+};
+
+// Draw items of every pass for one frame. Once sorted on their packed key
+// (pass, program, texture, mesh, depth) each pass is a contiguous range in
+// which items sharing a mesh follow each other and can be instanced.
+class RenderQueue final {
+   public:
+	RenderQueue(void);
+	~RenderQueue(void);
+
+	void clear(void);
+	// Add one item per mesh of the model, each one drawn with the variant
+	// matching its features, depth is the distance to the eye
+	void add(RenderPass pass, ShaderVariants const &variants, Entity *entity,
+			 Model *model, InstanceData const &instance, float depth);
+	void sort(void);
+	void getPassRange(RenderPass pass, size_t &begin, size_t &end) const;
+	std::vector<DrawItem> const &getItems(void) const;
+
+   private:
+	RenderQueue(RenderQueue const &src);
+
+	RenderQueue &operator=(RenderQueue const &rhs);
+
+	static uint64_t _makeKey(RenderPass pass, GLuint program, GLuint texture,
+							 size_t meshId, float depth);
+	// All meshes of a rigged entity stay together, they share its pose even
+	// when drawn with different variants
+	static uint64_t _makeRiggedKey(RenderPass pass, GLuint program,
+								   size_t entityId, size_t meshIdx);
+
+	std::vector<DrawItem> _items;
+};
@@ -1,29 +1,75 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "engine/Engine.hpp"
 
+// Uniform buffer binding points of the std140 blocks shared by the shaders
+#define FRAME_BLOCK_BINDING 0
+#define MATERIAL_BLOCK_BINDING 1
+
+// Active uniform reflected at link time, location is -1 when the program
+// doesn't use it (setting it is then a no-op, like in OpenGL)
+struct UniformHandle {
+	GLint location = -1;
+	GLenum type = 0;
+	GLint size = 0;  // Number of elements for arrays, 1 otherwise
+};
+
+// Uniforms set for every draw call, resolved once per program (materials
+// come from the Material block)
+struct DrawUniforms {
+	UniformHandle boneTransforms;
+	UniformHandle cascadeIdx;  // Depth shader, shadow map layer
+};
+
 class ShaderProgram final {
    public:
+	// Defines ("NAME" or "NAME value") are inserted after the #version line
+	// of both sources
 	ShaderProgram(std::string const& vertexPath,
-				  std::string const& fragmentPath);
+				  std::string const& fragmentPath,
+				  std::vector<std::string> const& defines =
+					  std::vector<std::string>());
 	~ShaderProgram(void);
 
 	GLuint getID(void) const;
+	// Arrays can be found by their name with or without "[0]"
+	UniformHandle getUniform(std::string const& name) const;
+	DrawUniforms const& getDrawUniforms(void) const;
+
+	// By name, for setup code
 	void setBool(std::string const& name, bool value) const;
 	void setInt(std::string const& name, int value) const;
 	void setFloat(std::string const& name, float value) const;
 	void setVec3(std::string const& name, glm::vec3 const& value) const;
 	void setMat4(std::string const& name, glm::mat4 const& value) const;
 
+	// By handle, no string work for hot paths
+	void setBool(UniformHandle const& handle, bool value) const;
+	void setInt(UniformHandle const& handle, int value) const;
+	void setFloat(UniformHandle const& handle, float value) const;
+	void setVec3(UniformHandle const& handle, glm::vec3 const& value) const;
+	void setMat4(UniformHandle const& handle, glm::mat4 const& value) const;
+	// Upload at most handle.size matrices in one call
+	void setMat4Array(UniformHandle const& handle, glm::mat4 const* values,
+					  size_t count) const;
+
    private:
 	GLuint _vs;
 	GLuint _fs;
 	GLuint _ID;
+	std::unordered_map<std::string, UniformHandle> _uniforms;
+	DrawUniforms _drawUniforms;
 
 	ShaderProgram(void);
 	ShaderProgram(ShaderProgram const& src);
 
 	ShaderProgram& operator=(ShaderProgram const& rhs);
 
+	static std::string _addDefines(std::string const& code,
+								   std::vector<std::string> const& defines);
 	void _checkCompileErrors(GLuint shader, std::string type);
+	void _reflectUniforms(void);
+	void _bindUniformBlock(std::string const& name, GLuint binding);
 };
\ No newline at end of file
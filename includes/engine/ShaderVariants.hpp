@@ -0,0 +1,39 @@
+#pragma once
+
+#include "engine/ShaderProgram.hpp"
+
+// Features a shader variant is compiled with, each one is a #define in its
+// sources so that the shaders don't branch on them at runtime
+enum ShaderFeature {
+	FeatureRigged = 1 << 0,    // RIGGED, skinned vertices
+	FeatureTextured = 1 << 1,  // TEXTURED, diffuse texture sampled
+	FeatureAll = (1 << 2) - 1
+};
+
+// Every combination of a set of features for one pair of shader sources,
+// all compiled upfront to avoid hitches while drawing
+class ShaderVariants final {
+   public:
+	// Defines are added to every variant, as "NAME" or "NAME value"
+	ShaderVariants(std::string const &vertexPath,
+				   std::string const &fragmentPath, unsigned int featureMask,
+				   std::vector<std::string> const &defines =
+					   std::vector<std::string>());
+	~ShaderVariants(void);
+
+	// Features outside of the mask are ignored
+	ShaderProgram *get(unsigned int features) const;
+	std::vector<ShaderProgram *> const &getPrograms(void) const;
+	// Set a uniform on every variant, for setup code (changes the current
+	// program)
+	void setInt(std::string const &name, int value) const;
+
+   private:
+	ShaderVariants(void);
+	ShaderVariants(ShaderVariants const &src);
+
+	ShaderVariants &operator=(ShaderVariants const &rhs);
+
+	unsigned int _featureMask;
+	std::vector<ShaderProgram *> _programs;  // Indexed by features
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "engine/Engine.hpp"
+
+// Size of the cascade arrays in the Frame block
+#define MAX_SHADOW_CASCADES 4
+// Split depths blend uniform (0) and logarithmic (1) distributions
+#define SHADOW_CASCADE_LAMBDA 0.6f
+// Room added around a fitted area, so small camera moves keep the fit
+#define SHADOW_FIT_MARGIN 0.1f
+// A fit is redone once it covers more than this many times the needed area
+#define SHADOW_FIT_SLACK 2.0f
+
+// Orthographic light frustums fitted to slices of the camera frustum, clipped
+// to the scene bounds. Depth ranges cover the whole scene so that casters
+// outside of the view still throw their shadows in it.
+class ShadowCascades final {
+   public:
+	ShadowCascades(void);
+	~ShadowCascades(void);
+
+	// Fit again every cascade when forced, otherwise only those which don't
+	// hold their needed area anymore. Returns true if a matrix changed.
+	bool update(glm::mat4 const &lightView, glm::mat4 const &cameraView,
+				glm::mat4 const &cameraProjection, glm::vec3 const &sceneMin,
+				glm::vec3 const &sceneMax, size_t count, bool forceFit);
+	size_t getCount(void) const;
+	// Light projection times light view
+	glm::mat4 const &getMatrix(size_t idx) const;
+	// Camera view depth at which a cascade ends
+	float getSplit(size_t idx) const;
+
+   private:
+	struct Cascade {
+		glm::vec3 min = glm::vec3(0.0f);  // Fitted box in light view space
+		glm::vec3 max = glm::vec3(0.0f);
+		glm::mat4 matrix = glm::mat4(1.0f);
+		float split = 0.0f;
+	};
+
+	ShadowCascades(ShadowCascades const &src);
+
+	ShadowCascades &operator=(ShadowCascades const &rhs);
+
+	static bool _fit(Cascade &cascade, glm::mat4 const &lightView,
+					 glm::vec3 const &needMin, glm::vec3 const &needMax,
+					 bool forceFit);
+
+	Cascade _cascades[MAX_SHADOW_CASCADES];
+	size_t _count = 1;
+};
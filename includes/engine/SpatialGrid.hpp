@@ -0,0 +1,54 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "engine/Entity.hpp"
+#include "engine/LayerMask.hpp"
+
+#define SPATIAL_GRID_CELL_SIZE 2.0f
+
+// Uniform spatial hash on collider AABBs, used as collision broadphase
+class SpatialGrid final {
+   public:
+	SpatialGrid(float cellSize = SPATIAL_GRID_CELL_SIZE);
+	~SpatialGrid(void);
+
+	void insert(Entity *entity);
+	void update(Entity *entity);
+	void remove(Entity *entity);
+	void clear(void);
+	bool contains(Entity *entity) const;
+	size_t size(void) const;
+	// Append every registered entity on one of the given layers whose cells
+	// overlap the given AABB
+	void query(float left, float top, float right, float bot,
+			   std::vector<Entity *> &result, LayerMask layers = ALL_LAYERS);
+
+   private:
+	struct CellRange {
+		int minX;
+		int minZ;
+		int maxX;
+		int maxZ;
+	};
+	struct Record {
+		Entity *entity;
+		CellRange range;
+		size_t queryStamp;
+	};
+
+	SpatialGrid(SpatialGrid const &src);
+
+	SpatialGrid &operator=(SpatialGrid const &rhs);
+
+	int _toCell(float coord) const;
+	uint64_t _cellKey(int x, int z) const;
+	CellRange _getCellRange(Entity *entity) const;
+	void _link(Record *record);
+	void _unlink(Record *record);
+
+	float _cellSize;
+	size_t _queryStamp;
+	std::unordered_map<uint64_t, std::vector<Record *>> _cells;
+	std::unordered_map<size_t, Record> _records;
+};
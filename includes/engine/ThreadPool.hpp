@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#include "engine/Engine.hpp"
+
+// Fixed set of workers running the indices of one task at a time, the
+// calling thread takes part in it as well
+class ThreadPool final {
+   public:
+	// Threads including the caller, 0 for one per hardware thread. Workers
+	// are only started by the first task needing them.
+	ThreadPool(size_t threadCount = 0);
+	~ThreadPool(void);
+
+	size_t getThreadCount(void) const;
+	// Call task(idx) for every idx below count, returns once all are done
+	void run(size_t count, std::function<void(size_t)> const &task);
+
+   private:
+	ThreadPool(ThreadPool const &src);
+
+	ThreadPool &operator=(ThreadPool const &rhs);
+
+	void _work(void);
+	// Run the remaining indices, the lock is released while running them
+	void _runIndices(std::unique_lock<std::mutex> &lock);
+
+	size_t _threadCount;
+	std::vector<std::thread> _workers;
+	std::mutex _mutex;
+	std::condition_variable _wakeCondition;
+	std::condition_variable _doneCondition;
+	std::function<void(size_t)> const *_task = nullptr;
+	size_t _count = 0;
+	size_t _next = 0;
+	size_t _pending = 0;  // Indices not finished yet
+	bool _isStopping = false;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "engine/Entity.hpp"
+#include "engine/LayerMask.hpp"
+
+#define TILE_SIZE 1.0f
+
+// Occupancy grid of static, grid aligned rectangle colliders (walls, boxes)
+class TileLayer final {
+   public:
+	TileLayer(void);
+	~TileLayer(void);
+
+	static bool isTile(Entity *entity);
+
+	bool insert(Entity *entity);
+	void remove(Entity *entity);
+	void clear(void);
+	bool contains(Entity *entity) const;
+	size_t size(void) const;
+	Entity *getTile(int x, int z) const;
+	int toTile(float coord) const;
+	// Append every tile on one of the given layers whose cell overlaps the
+	// given AABB
+	void query(float left, float top, float right, float bot,
+			   std::vector<Entity *> &result,
+			   LayerMask layers = ALL_LAYERS) const;
+
+   private:
+	TileLayer(TileLayer const &src);
+
+	TileLayer &operator=(TileLayer const &rhs);
+
+	uint64_t _tileKey(int x, int z) const;
+
+	std::unordered_map<uint64_t, Entity *> _tiles;
+	std::unordered_map<size_t, uint64_t> _keys;
+};
@@ -21,7 +21,8 @@ enum LayerTag {
 	BombLayer,
 	ExplosionLayer,
 	PerkLayer,
-	PortalLayer
+	PortalLayer,
+	LayerCount
 };
 
 class Bomberman : public AGame {
@@ -42,6 +43,7 @@ class Bomberman : public AGame {
 	virtual int getFirstSceneIdx(void) const;
 	virtual int getStartingMusicVolume(void) const;
 	virtual int getStartingSoundsVolume(void) const;
+	virtual RenderQuality getRenderQuality(void) const;
 
 	Save &getSave(void);
 
@@ -9,6 +9,9 @@ struct Save {
 		RESOLUTIONS;
 	static const std::vector<std::tuple<std::string, bool>> FULL_SCREEN;
 	static const std::vector<std::tuple<std::string, int>> VOLUMES;
+	static const std::vector<std::tuple<std::string, RenderQuality>>
+		QUALITIES;
+	static const std::vector<std::tuple<std::string, bool>> DYNAMIC_RESOLUTION;
 
 	int upKey = KEY_W;
 	int leftKey = KEY_A;
@@ -19,6 +22,8 @@ struct Save {
 	size_t resolutionsIdx = 0;
 	size_t musicVolume = 10;
 	size_t soundsVolume = 10;
+	size_t qualityIdx = 2;
+	size_t dynamicResolution = 0;
 
 	Save();
 	virtual ~Save(void) {}
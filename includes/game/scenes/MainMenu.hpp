@@ -42,4 +42,6 @@ class MainMenu : public SceneTools {
 	int _resolutionsIdx;
 	int _musicVolume;
 	int _soundsVolume;
+	int _qualityIdx;
+	int _dynamicResolution;
 };
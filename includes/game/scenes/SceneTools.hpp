@@ -3,6 +3,7 @@
 #include "engine/Camera.hpp"
 #include "engine/Engine.hpp"
 #include "engine/Entity.hpp"
+#include "engine/EntityRegistry.hpp"
 #include "engine/GUI/GUI.hpp"
 #include "game/Bomberman.hpp"
 
@@ -20,7 +21,7 @@ struct Node {
 	// next nodes by distance from the target
 	std::map<size_t, std::vector<Node *>> runAwayNodesByDist;
 	// Entities with hitbox on this node
-	std::vector<Entity *> entitiesOnMe;
+	std::vector<EntityHandle> entitiesOnMe;
 
 	size_t dist;
 	size_t runAwayDist;
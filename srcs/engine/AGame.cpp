@@ -9,10 +9,11 @@ ModelInfo::ModelInfo(std::string modelPath,
 	: modelPath(modelPath), animMap(animMap) {}
 
 AGame::AGame(size_t enumSize)
-	: _collisionTable(std::vector<std::vector<bool>>(enumSize)) {
-	for (auto &collisionTag : _collisionTable) {
-		collisionTag = std::vector<bool>(enumSize, true);
-	}
+	: _collisionMasks(std::vector<LayerMask>(enumSize, layersUpTo(enumSize))) {
+	if (enumSize > MAX_LAYERS)
+		throw std::runtime_error("\033[0;31m:Error:\033[0m Too many layers (" +
+								 std::to_string(enumSize) + " given, " +
+								 std::to_string(MAX_LAYERS) + " max) !");
 }
 
 AGame::~AGame(void) {
@@ -44,8 +45,12 @@ Light *AGame::getLoadingLight(void) const { return _loadingLight; }
 
 Skybox *AGame::getLoadingSkybox(void) const { return _loadingSkybox; }
 
-std::vector<std::vector<bool>> const &AGame::getCollisionTable(void) {
-	return _collisionTable;
+std::map<std::string, ModelInfo> const &AGame::getAllAssets(void) const {
+	return _allAssets;
+}
+
+std::vector<LayerMask> const &AGame::getCollisionMasks(void) const {
+	return _collisionMasks;
 }
 
 std::vector<std::tuple<float, std::string, std::string>>
@@ -80,14 +85,33 @@ int AGame::getStartingMusicVolume(void) const { return 5; }
 
 int AGame::getStartingSoundsVolume(void) const { return 10; }
 
+float AGame::getTickRate(void) const { return 60.0f; }
+
+RenderQuality AGame::getRenderQuality(void) const {
+	return {2048, 2, 1, 4, 1.0f, false};
+}
+
+void AGame::setCollisionMasks(LayerMask const *masks, size_t layerCount) {
+	if (layerCount != _collisionMasks.size()) {
+		throw std::runtime_error(
+			"\033[0;31m:Error:\033[0m Invalid collision masks count given !");
+	}
+	_collisionMasks.assign(masks, masks + layerCount);
+}
+
 void AGame::setLayerCollision(int layer1, int layer2, bool doCollide) {
-	if ((size_t)layer1 >= _collisionTable.size() ||
-		(size_t)layer2 >= _collisionTable.size()) {
+	if ((size_t)layer1 >= _collisionMasks.size() ||
+		(size_t)layer2 >= _collisionMasks.size()) {
 		throw std::runtime_error(
 			"\033[0;31m:Error:\033[0m Invalid layer for collision given !");
 	}
-	_collisionTable[layer1][layer2] = doCollide;
-	_collisionTable[layer2][layer1] = doCollide;
+	if (doCollide) {
+		_collisionMasks[layer1] |= layerBit(layer2);
+		_collisionMasks[layer2] |= layerBit(layer1);
+	} else {
+		_collisionMasks[layer1] &= ~layerBit(layer2);
+		_collisionMasks[layer2] &= ~layerBit(layer1);
+	}
 }
 
 void AGame::setGameRenderer(GameRenderer *gameRenderer) {
@@ -226,5 +250,5 @@ void AGame::loadSounds(void) {
 		}
 	}
 
-	_audioManager->loadSounds(neededSounds);
+	if (_audioManager) _audioManager->loadSounds(neededSounds);
 }
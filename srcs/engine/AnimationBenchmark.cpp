@@ -0,0 +1,312 @@
+#include "engine/AnimationBenchmark.hpp"
+#include "engine/AGame.hpp"
+
+#include <iomanip>
+
+AnimationBenchmark::AnimationBenchmark(ModelInfo const &modelInfo)
+	: _modelPath(modelInfo.modelPath),
+	  _model(new Model(modelInfo.modelPath)),
+	  _scalarBatch(false) {
+	for (auto const &animInfo : modelInfo.animMap)
+		_model->addAnimation(animInfo.first, animInfo.second);
+}
+
+AnimationBenchmark::~AnimationBenchmark(void) { delete _model; }
+
+bool AnimationBenchmark::run(size_t entityCount) {
+	static const char *modeNames[BenchmarkModeCount] = {
+		"played forward", "at random times", "batched"};
+	if (_model->getClipIds().empty()) {
+		std::cerr << "\033[0;33m:Warning:\033[0m " << _modelPath
+				  << " has no animation to sample" << std::endl;
+		return true;
+	}
+	entityCount = std::max<size_t>(entityCount, 1);
+	std::cout << _modelPath << ": " << _model->getJointCount()
+			  << " joints, " << entityCount << " entities, "
+			  << (ANIMATION_KERNELS_SSE ? "SSE" : "scalar") << " kernels"
+			  << std::endl;
+	size_t jointCount = std::max<size_t>(_model->getJointCount(), 1);
+	bool isValid = true;
+	for (auto const &clip : _model->getClipIds()) {
+		std::cout << "  " << clip.first << ":" << std::endl;
+		for (int mode = 0; mode < BenchmarkModeCount; mode++) {
+			double jointsPerSecond = _measure(
+				clip.first, entityCount, static_cast<BenchmarkMode>(mode));
+			double entitiesPerMs = jointsPerSecond / jointCount / 1000.0;
+			std::cout << std::fixed << std::setprecision(0) << "    "
+					  << modeNames[mode] << ": " << jointsPerSecond
+					  << " joints/s, " << std::setprecision(1)
+					  << entitiesPerMs << " entities/ms" << std::endl;
+		}
+		float cursorError = _getCursorError(clip.first, entityCount);
+		float batchError = _getBatchError(clip.first, entityCount, _batch);
+		float scalarError =
+			_getBatchError(clip.first, entityCount, _scalarBatch);
+		std::cout << std::scientific << std::setprecision(2)
+				  << "    batched palettes error: " << batchError
+				  << ", scalar kernels: " << scalarError << std::endl
+				  << "    cursors palettes error: " << cursorError
+				  << std::endl;
+		if (std::max(batchError, scalarError) >
+			ANIMATION_BENCHMARK_MAX_ERROR) {
+			std::cerr << "\033[0;33m:Warning:\033[0m " << clip.first
+					  << " batched palettes differ from the scalar ones"
+					  << std::endl;
+			isValid = false;
+		}
+		if (cursorError > ANIMATION_BENCHMARK_MAX_ERROR) {
+			std::cerr << "\033[0;33m:Warning:\033[0m " << clip.first
+					  << " keys found from the cursors differ from the "
+						 "searched ones"
+					  << std::endl;
+			isValid = false;
+		}
+		_printScaling(clip.first);
+	}
+	return isValid;
+}
+
+void AnimationBenchmark::_bindPoses(std::string animName,
+									std::vector<Pose> &poses,
+									std::vector<double> &times) const {
+	double duration =
+		_model->getClip(_model->getClipId(animName))->getDuration();
+	for (size_t idx = 0; idx < poses.size(); idx++) {
+		_model->bindClip(animName, poses[idx]);
+		times[idx] = duration * idx / poses.size();
+	}
+}
+
+double AnimationBenchmark::_measure(std::string const &animName,
+									size_t entityCount, BenchmarkMode mode) {
+	typedef std::chrono::steady_clock BenchmarkClock;
+	std::vector<Pose> poses(entityCount);
+	std::vector<double> times(entityCount);
+	_bindPoses(animName, poses, times);
+	// Drawing them while sampling would be timed as well
+	double duration =
+		_model->getClip(_model->getClipId(animName))->getDuration();
+	std::vector<double> randoms(ANIMATION_BENCHMARK_RANDOM_TIMES);
+	for (double &time : randoms) time = duration * rand() / RAND_MAX;
+
+	size_t sampledJoints = 0;
+	size_t nextRandom = 0;
+	double elapsed = 0.0;
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	do {
+		if (mode == BenchmarkBatched) _batch.clear();
+		for (size_t idx = 0; idx < entityCount; idx++) {
+			if (mode == BenchmarkRandom)
+				times[idx] = randoms[nextRandom++ % randoms.size()];
+			else
+				_model->advanceAnimation(&times[idx], poses[idx], true,
+										 ANIMATION_BENCHMARK_STEP, 1.0f);
+			if (mode == BenchmarkBatched)
+				_batch.add(_model, &poses[idx], times[idx]);
+			else
+				_model->samplePose(times[idx], poses[idx]);
+		}
+		if (mode == BenchmarkBatched) _batch.sample();
+		sampledJoints += entityCount * _model->getJointCount();
+		elapsed = std::chrono::duration<double>(BenchmarkClock::now() - start)
+					  .count();
+	} while (elapsed < ANIMATION_BENCHMARK_DURATION);
+	return sampledJoints / elapsed;
+}
+
+double AnimationBenchmark::_measureThreads(std::string const &animName,
+										   size_t threadCount) {
+	typedef std::chrono::steady_clock BenchmarkClock;
+	AnimationSystem animationSystem(threadCount);
+	std::vector<Pose> poses(ANIMATION_BENCHMARK_SCALING_ENTITIES);
+	std::vector<double> times(poses.size());
+	_bindPoses(animName, poses, times);
+
+	size_t animatedEntities = 0;
+	double elapsed = 0.0;
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	// Same work as a frame of the game, animations advance on this thread
+	do {
+		animationSystem.clear();
+		for (size_t idx = 0; idx < poses.size(); idx++) {
+			_model->advanceAnimation(&times[idx], poses[idx], true,
+									 ANIMATION_BENCHMARK_STEP, 1.0f);
+			animationSystem.add(_model, &poses[idx], times[idx]);
+		}
+		animationSystem.sample();
+		animatedEntities += poses.size();
+		elapsed = std::chrono::duration<double>(BenchmarkClock::now() - start)
+					  .count();
+	} while (elapsed < ANIMATION_BENCHMARK_DURATION);
+	return animatedEntities / elapsed / 1000.0;
+}
+
+float AnimationBenchmark::_getBatchError(std::string const &animName,
+										 size_t entityCount,
+										 PoseBatch &batch) {
+	std::vector<Pose> scalarPoses(entityCount);
+	std::vector<Pose> batchedPoses(entityCount);
+	std::vector<double> times(entityCount);
+	_bindPoses(animName, scalarPoses, times);
+	_bindPoses(animName, batchedPoses, times);
+	batch.clear();
+	for (size_t idx = 0; idx < entityCount; idx++) {
+		_model->samplePose(times[idx], scalarPoses[idx]);
+		batch.add(_model, &batchedPoses[idx], times[idx]);
+	}
+	batch.sample();
+	float error = 0.0f;
+	for (size_t idx = 0; idx < entityCount; idx++)
+		error = std::max(
+			error, _getPaletteError(scalarPoses[idx], batchedPoses[idx]));
+	return error;
+}
+
+float AnimationBenchmark::_getCursorError(std::string const &animName,
+										  size_t entityCount) {
+	std::vector<Pose> forwardPoses(entityCount);
+	std::vector<double> times(entityCount);
+	_bindPoses(animName, forwardPoses, times);
+	// Poses bound but never sampled, their cursors are all on the first key
+	std::vector<Pose> const boundPoses(forwardPoses);
+	float error = 0.0f;
+	for (size_t step = 0; step < ANIMATION_BENCHMARK_CHECK_STEPS; step++) {
+		for (size_t idx = 0; idx < entityCount; idx++) {
+			_model->advanceAnimation(&times[idx], forwardPoses[idx], true,
+									 ANIMATION_BENCHMARK_STEP, 1.0f);
+			_model->samplePose(times[idx], forwardPoses[idx]);
+			Pose searchedPose(boundPoses[idx]);
+			_model->samplePose(times[idx], searchedPose);
+			error = std::max(
+				error, _getPaletteError(searchedPose, forwardPoses[idx]));
+		}
+	}
+	return error;
+}
+
+float AnimationBenchmark::_getPaletteError(Pose const &expected,
+										   Pose const &actual) {
+	float error = 0.0f;
+	for (size_t joint = 0; joint < MAX_JOINTS; joint++) {
+		for (int col = 0; col < 4; col++) {
+			for (int row = 0; row < 4; row++)
+				error = std::max(error,
+								 std::abs(expected.palette[joint][col][row] -
+										  actual.palette[joint][col][row]));
+		}
+	}
+	return error;
+}
+
+void AnimationBenchmark::_printScaling(std::string const &animName) {
+	size_t coreCount =
+		std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	double reference = 0.0;
+	std::cout << "    " << ANIMATION_BENCHMARK_SCALING_ENTITIES
+			  << " entities with the AnimationSystem:" << std::endl;
+	for (size_t threadCount = 1; threadCount <= coreCount; threadCount++) {
+		double entitiesPerMs = _measureThreads(animName, threadCount);
+		if (threadCount == 1) reference = entitiesPerMs;
+		std::cout << std::fixed << std::setprecision(1) << "      "
+				  << threadCount << " thread(s): " << entitiesPerMs
+				  << " entities/ms, " << std::setprecision(2) << "x"
+				  << entitiesPerMs / reference << std::endl;
+	}
+}
+
+bool AnimationBenchmark::checkKernels(void) {
+	static const size_t laneCounts[] = {
+		1, 2, 3, 4, 5, 6, 7, 8, 9, ANIMATION_BENCHMARK_CHECK_LANES};
+	bool isValid = true;
+	for (int useSSE = 0; useSSE <= ANIMATION_KERNELS_SSE; useSSE++) {
+		float error = 0.0f;
+		for (size_t laneCount : laneCounts)
+			error = std::max(error, _getKernelsError(laneCount, useSSE != 0));
+		std::cout << (useSSE ? "SSE" : "scalar") << " kernels, 1 to "
+				  << ANIMATION_BENCHMARK_CHECK_LANES
+				  << " lanes: " << std::scientific << std::setprecision(2)
+				  << error << std::endl;
+		if (error > ANIMATION_BENCHMARK_MAX_ERROR) {
+			std::cerr << "\033[0;33m:Warning:\033[0m "
+					  << (useSSE ? "SSE" : "scalar")
+					  << " kernels differ from glm by more than "
+					  << ANIMATION_BENCHMARK_MAX_ERROR << std::endl;
+			isValid = false;
+		}
+	}
+	return isValid;
+}
+
+float AnimationBenchmark::_getKernelsError(size_t laneCount, bool useSSE) {
+	KeyLanes translations(3);
+	KeyLanes rotations(4);
+	KeyLanes scalings(3);
+	std::vector<glm::mat4> expected(laneCount);
+	for (size_t lane = 0; lane < laneCount; lane++) {
+		float ratio = _getRandom(0.0f, 1.0f);
+		glm::vec3 positions[2];
+		glm::quat quats[2];
+		glm::vec3 scales[2];
+		for (size_t key = 0; key < 2; key++) {
+			positions[key] = glm::vec3(_getRandom(-1.0f, 1.0f),
+									   _getRandom(-1.0f, 1.0f),
+									   _getRandom(-1.0f, 1.0f));
+			quats[key] = glm::normalize(glm::quat(
+				_getRandom(-1.0f, 1.0f), _getRandom(-1.0f, 1.0f),
+				_getRandom(-1.0f, 1.0f), _getRandom(-1.0f, 1.0f)));
+			scales[key] = glm::vec3(_getRandom(0.8f, 1.2f),
+									_getRandom(0.8f, 1.2f),
+									_getRandom(0.8f, 1.2f));
+		}
+		// Some tracks are constant, their lanes have the same keys
+		if (lane % 4 == 3) {
+			positions[1] = positions[0];
+			quats[1] = quats[0];
+			scales[1] = scales[0];
+		}
+		// glm vectors and quaternions store x, y, z (and w) in this order
+		translations.push(ratio, &positions[0].x, &positions[1].x);
+		rotations.push(ratio, &quats[0].x, &quats[1].x);
+		scalings.push(ratio, &scales[0].x, &scales[1].x);
+		// As AnimationClip::sample() does
+		expected[lane] =
+			glm::translate(glm::mat4(1.0f), positions[0] * (1.0f - ratio) +
+												positions[1] * ratio) *
+			glm::mat4(glm::slerp(quats[0], quats[1], ratio)) *
+			glm::scale(glm::mat4(1.0f),
+					   scales[0] * (1.0f - ratio) + scales[1] * ratio);
+	}
+
+	std::vector<float> results[TrackCount][4];
+	lerpLanes(translations, results[TrackPosition], useSSE);
+	nlerpLanes(rotations, results[TrackRotation], useSSE);
+	lerpLanes(scalings, results[TrackScaling], useSSE);
+	std::vector<Affine> locals(laneCount);
+	composeAffines(results[TrackPosition], results[TrackRotation],
+				   results[TrackScaling], laneCount, &locals.front(), useSSE);
+	float error = 0.0f;
+	for (size_t lane = 0; lane < laneCount; lane++) {
+		// Products chain each lane to the next one, as a parent to a child,
+		// compared with the product of the same locals to leave out their
+		// own error
+		size_t next = (lane + 1) % laneCount;
+		Affine product;
+		multiplyAffines(locals[lane], locals[next], product, useSSE);
+		glm::mat4 const actuals[2] = {toMat4(locals[lane]), toMat4(product)};
+		glm::mat4 const references[2] = {
+			expected[lane], toMat4(locals[lane]) * toMat4(locals[next])};
+		for (size_t idx = 0; idx < 2; idx++) {
+			for (int col = 0; col < 4; col++) {
+				for (int row = 0; row < 4; row++)
+					error = std::max(error, std::abs(references[idx][col][row] -
+													 actuals[idx][col][row]));
+			}
+		}
+	}
+	return error;
+}
+
+float AnimationBenchmark::_getRandom(float min, float max) {
+	return min + (max - min) * rand() / RAND_MAX;
+}
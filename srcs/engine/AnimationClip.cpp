@@ -0,0 +1,162 @@
+#include "engine/AnimationClip.hpp"
+
+#include <algorithm>
+
+AnimationClip::AnimationClip(double duration, size_t jointCount)
+	: _duration(duration), _jointCount(jointCount) {
+	_positions.firsts.resize(jointCount, 0);
+	_positions.counts.resize(jointCount, 0);
+	_rotations.firsts.resize(jointCount, 0);
+	_rotations.counts.resize(jointCount, 0);
+	_scalings.firsts.resize(jointCount, 0);
+	_scalings.counts.resize(jointCount, 0);
+}
+
+AnimationClip::~AnimationClip(void) {}
+
+double AnimationClip::getDuration(void) const { return _duration; }
+
+size_t AnimationClip::getJointCount(void) const { return _jointCount; }
+
+void AnimationClip::setTrack(size_t jointIdx, aiNodeAnim const *nodeAnim) {
+	if (jointIdx >= _jointCount) return;
+	_positions.firsts[jointIdx] = _positions.times.size();
+	_positions.counts[jointIdx] = nodeAnim->mNumPositionKeys;
+	for (size_t i = 0; i < nodeAnim->mNumPositionKeys; i++) {
+		aiVectorKey const &key = nodeAnim->mPositionKeys[i];
+		_positions.times.push_back(key.mTime);
+		_positions.values.push_back(
+			glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+	}
+	_rotations.firsts[jointIdx] = _rotations.times.size();
+	_rotations.counts[jointIdx] = nodeAnim->mNumRotationKeys;
+	for (size_t i = 0; i < nodeAnim->mNumRotationKeys; i++) {
+		aiQuatKey const &key = nodeAnim->mRotationKeys[i];
+		_rotations.times.push_back(key.mTime);
+		_rotations.values.push_back(
+			glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z));
+	}
+	_scalings.firsts[jointIdx] = _scalings.times.size();
+	_scalings.counts[jointIdx] = nodeAnim->mNumScalingKeys;
+	for (size_t i = 0; i < nodeAnim->mNumScalingKeys; i++) {
+		aiVectorKey const &key = nodeAnim->mScalingKeys[i];
+		_scalings.times.push_back(key.mTime);
+		_scalings.values.push_back(
+			glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+	}
+}
+
+bool AnimationClip::hasTrack(size_t jointIdx) const {
+	return jointIdx < _jointCount &&
+		   (_positions.counts[jointIdx] > 0 ||
+			_rotations.counts[jointIdx] > 0 || _scalings.counts[jointIdx] > 0);
+}
+
+glm::mat4 AnimationClip::sample(size_t jointIdx, float time,
+								unsigned int *cursors) const {
+	glm::vec3 scaling(1.0f);
+	glm::vec3 position(0.0f);
+	glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+	unsigned int first;
+	unsigned int count;
+	unsigned int key;
+	float mixRatio;
+
+	first = _scalings.firsts[jointIdx];
+	count = _scalings.counts[jointIdx];
+	if (count > 0) {
+		key = first + _findKey(&_scalings.times[first], count, time,
+							   cursors[TrackScaling], mixRatio);
+		scaling = count == 1 ? _scalings.values[key]
+							 : _scalings.values[key] * (1.0f - mixRatio) +
+								   _scalings.values[key + 1] * mixRatio;
+	}
+
+	first = _positions.firsts[jointIdx];
+	count = _positions.counts[jointIdx];
+	if (count > 0) {
+		key = first + _findKey(&_positions.times[first], count, time,
+							   cursors[TrackPosition], mixRatio);
+		position = count == 1 ? _positions.values[key]
+							  : _positions.values[key] * (1.0f - mixRatio) +
+									_positions.values[key + 1] * mixRatio;
+	}
+
+	first = _rotations.firsts[jointIdx];
+	count = _rotations.counts[jointIdx];
+	if (count > 0) {
+		key = first + _findKey(&_rotations.times[first], count, time,
+							   cursors[TrackRotation], mixRatio);
+		rotation = count == 1 ? _rotations.values[key]
+							  : glm::slerp(_rotations.values[key],
+										   _rotations.values[key + 1],
+										   mixRatio);
+	}
+
+	return glm::translate(glm::mat4(1.0f), position) * glm::mat4(rotation) *
+		   glm::scale(glm::mat4(1.0f), scaling);
+}
+
+void AnimationClip::gatherKeys(size_t jointIdx, float time,
+							   unsigned int *cursors,
+							   KeyLanes *const *lanes) const {
+	_gatherTrack(_positions, jointIdx, time, cursors[TrackPosition],
+				 glm::vec3(0.0f), *lanes[TrackPosition]);
+	_gatherTrack(_rotations, jointIdx, time, cursors[TrackRotation],
+				 glm::quat(1.0f, 0.0f, 0.0f, 0.0f), *lanes[TrackRotation]);
+	_gatherTrack(_scalings, jointIdx, time, cursors[TrackScaling],
+				 glm::vec3(1.0f), *lanes[TrackScaling]);
+}
+
+void AnimationClip::gatherIdentity(KeyLanes *const *lanes) {
+	static const float zeros[3] = {0.0f, 0.0f, 0.0f};
+	static const float identity[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+	static const float ones[3] = {1.0f, 1.0f, 1.0f};
+	lanes[TrackPosition]->push(0.0f, zeros, zeros);
+	lanes[TrackRotation]->push(0.0f, identity, identity);
+	lanes[TrackScaling]->push(0.0f, ones, ones);
+}
+
+template <typename T>
+void AnimationClip::_gatherTrack(KeyArrays<T> const &arrays, size_t jointIdx,
+								 float time, unsigned int &cursor,
+								 T const &defaultValue, KeyLanes &lanes) {
+	// glm vectors and quaternions store x, y, z (and w) in this order
+	unsigned int count = arrays.counts[jointIdx];
+	if (count == 0) {
+		lanes.push(0.0f, &defaultValue.x, &defaultValue.x);
+		return;
+	}
+	unsigned int first = arrays.firsts[jointIdx];
+	float ratio;
+	unsigned int key =
+		first + _findKey(&arrays.times[first], count, time, cursor, ratio);
+	T const &from = arrays.values[key];
+	T const &to = count == 1 ? from : arrays.values[key + 1];
+	lanes.push(ratio, &from.x, &to.x);
+}
+
+unsigned int AnimationClip::_findKey(float const *times, unsigned int count,
+									 float time, unsigned int &cursor,
+									 float &ratio) {
+	ratio = 0.0f;
+	if (count < 2) {
+		cursor = 0;
+		return 0;
+	}
+	unsigned int key = cursor;
+	if (key + 1 < count && times[key] <= time && time < times[key + 1]) {
+		// Same segment as last frame
+	} else if (key + 2 < count && times[key + 1] <= time &&
+			   time < times[key + 2]) {
+		key++;
+	} else {
+		// Looped, jumped or first sample
+		key = std::upper_bound(times, times + count, time) - times;
+		key = std::min(std::max(key, 1u), count - 1) - 1;
+	}
+	cursor = key;
+	ratio = (time - times[key]) / (times[key + 1] - times[key]);
+	ratio = std::min(std::max(ratio, 0.0f), 1.0f);
+	return key;
+}
@@ -0,0 +1,270 @@
+#include "engine/AnimationKernels.hpp"
+
+#if ANIMATION_KERNELS_SSE
+#include <xmmintrin.h>
+#endif
+
+KeyLanes::KeyLanes(size_t width) : _width(std::min<size_t>(width, 4)) {}
+
+KeyLanes::~KeyLanes(void) {}
+
+void KeyLanes::clear(void) {
+	ratios.clear();
+	for (size_t comp = 0; comp < _width; comp++) {
+		from[comp].clear();
+		to[comp].clear();
+	}
+}
+
+void KeyLanes::push(float ratio, float const *fromKey, float const *toKey) {
+	ratios.push_back(ratio);
+	for (size_t comp = 0; comp < _width; comp++) {
+		from[comp].push_back(fromKey[comp]);
+		to[comp].push_back(toKey[comp]);
+	}
+}
+
+size_t KeyLanes::size(void) const { return ratios.size(); }
+
+size_t KeyLanes::getWidth(void) const { return _width; }
+
+// Ratio of a lerp that follows a slerp, from its ratio and the cosine of
+// the angle between the keys (polynomial fit by Kronenberg and Kapoulkine)
+static float _correctRatio(float ratio, float cosTheta) {
+	float a = 1.0904f + cosTheta * (-3.2452f + cosTheta * (3.55645f -
+															cosTheta * 1.43519f));
+	float b = 0.848013f + cosTheta * (-1.06021f + cosTheta * 0.215638f);
+	float k = a * (ratio - 0.5f) * (ratio - 0.5f) + b;
+	return ratio + ratio * (ratio - 0.5f) * (ratio - 1.0f) * k;
+}
+
+#if ANIMATION_KERNELS_SSE
+static __m128 _correctRatio(__m128 ratio, __m128 cosTheta) {
+	__m128 a = _mm_sub_ps(_mm_set1_ps(3.55645f),
+						  _mm_mul_ps(cosTheta, _mm_set1_ps(1.43519f)));
+	a = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(cosTheta, a));
+	a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(cosTheta, a));
+	__m128 b = _mm_add_ps(_mm_set1_ps(-1.06021f),
+						  _mm_mul_ps(cosTheta, _mm_set1_ps(0.215638f)));
+	b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(cosTheta, b));
+	__m128 centered = _mm_sub_ps(ratio, _mm_set1_ps(0.5f));
+	__m128 k = _mm_add_ps(_mm_mul_ps(a, _mm_mul_ps(centered, centered)), b);
+	__m128 offset = _mm_mul_ps(
+		_mm_mul_ps(ratio, centered),
+		_mm_mul_ps(_mm_sub_ps(ratio, _mm_set1_ps(1.0f)), k));
+	return _mm_add_ps(ratio, offset);
+}
+#endif
+
+void lerpLanes(KeyLanes const &lanes, std::vector<float> *out, bool useSSE) {
+	size_t count = lanes.size();
+	size_t lane = 0;
+	for (size_t comp = 0; comp < lanes.getWidth(); comp++)
+		out[comp].resize(count);
+#if ANIMATION_KERNELS_SSE
+	for (; useSSE && lane + 4 <= count; lane += 4) {
+		__m128 ratio = _mm_loadu_ps(&lanes.ratios[lane]);
+		for (size_t comp = 0; comp < lanes.getWidth(); comp++) {
+			__m128 from = _mm_loadu_ps(&lanes.from[comp][lane]);
+			__m128 to = _mm_loadu_ps(&lanes.to[comp][lane]);
+			// from * (1 - ratio) + to * ratio, as the scalar loop
+			__m128 value = _mm_add_ps(
+				_mm_mul_ps(from, _mm_sub_ps(_mm_set1_ps(1.0f), ratio)),
+				_mm_mul_ps(to, ratio));
+			_mm_storeu_ps(&out[comp][lane], value);
+		}
+	}
+#else
+	(void)useSSE;
+#endif
+	for (; lane < count; lane++) {
+		float ratio = lanes.ratios[lane];
+		for (size_t comp = 0; comp < lanes.getWidth(); comp++)
+			out[comp][lane] = lanes.from[comp][lane] * (1.0f - ratio) +
+							  lanes.to[comp][lane] * ratio;
+	}
+}
+
+void nlerpLanes(KeyLanes const &lanes, std::vector<float> *out,
+				bool useSSE) {
+	size_t count = lanes.size();
+	size_t lane = 0;
+	for (size_t comp = 0; comp < 4; comp++) out[comp].resize(count);
+#if ANIMATION_KERNELS_SSE
+	__m128 const signMask = _mm_set1_ps(-0.0f);
+	for (; useSSE && lane + 4 <= count; lane += 4) {
+		__m128 ratio = _mm_loadu_ps(&lanes.ratios[lane]);
+		__m128 from[4];
+		__m128 to[4];
+		__m128 cosTheta = _mm_setzero_ps();
+		for (size_t comp = 0; comp < 4; comp++) {
+			from[comp] = _mm_loadu_ps(&lanes.from[comp][lane]);
+			to[comp] = _mm_loadu_ps(&lanes.to[comp][lane]);
+			cosTheta = _mm_add_ps(cosTheta, _mm_mul_ps(from[comp], to[comp]));
+		}
+		// Flip the next key sign where the dot product is negative
+		__m128 flip = _mm_and_ps(cosTheta, signMask);
+		ratio = _correctRatio(ratio, _mm_andnot_ps(signMask, cosTheta));
+		__m128 fromRatio = _mm_sub_ps(_mm_set1_ps(1.0f), ratio);
+		__m128 toRatio = _mm_xor_ps(ratio, flip);
+		__m128 value[4];
+		__m128 lengthSquared = _mm_setzero_ps();
+		for (size_t comp = 0; comp < 4; comp++) {
+			value[comp] = _mm_add_ps(_mm_mul_ps(from[comp], fromRatio),
+									 _mm_mul_ps(to[comp], toRatio));
+			lengthSquared = _mm_add_ps(lengthSquared,
+									   _mm_mul_ps(value[comp], value[comp]));
+		}
+		__m128 length = _mm_sqrt_ps(lengthSquared);
+		for (size_t comp = 0; comp < 4; comp++)
+			_mm_storeu_ps(&out[comp][lane], _mm_div_ps(value[comp], length));
+	}
+#else
+	(void)useSSE;
+#endif
+	for (; lane < count; lane++) {
+		float ratio = lanes.ratios[lane];
+		float cosTheta = 0.0f;
+		for (size_t comp = 0; comp < 4; comp++)
+			cosTheta += lanes.from[comp][lane] * lanes.to[comp][lane];
+		ratio = _correctRatio(ratio, fabs(cosTheta));
+		float toRatio = cosTheta < 0.0f ? -ratio : ratio;
+		float lengthSquared = 0.0f;
+		for (size_t comp = 0; comp < 4; comp++) {
+			out[comp][lane] = lanes.from[comp][lane] * (1.0f - ratio) +
+							  lanes.to[comp][lane] * toRatio;
+			lengthSquared += out[comp][lane] * out[comp][lane];
+		}
+		float length = sqrt(lengthSquared);
+		for (size_t comp = 0; comp < 4; comp++) out[comp][lane] /= length;
+	}
+}
+
+void composeAffines(std::vector<float> const *translations,
+					std::vector<float> const *rotations,
+					std::vector<float> const *scalings, size_t count,
+					Affine *out, bool useSSE) {
+	size_t lane = 0;
+#if ANIMATION_KERNELS_SSE
+	__m128 const one = _mm_set1_ps(1.0f);
+	__m128 const two = _mm_set1_ps(2.0f);
+	for (; useSSE && lane + 4 <= count; lane += 4) {
+		__m128 x = _mm_loadu_ps(&rotations[0][lane]);
+		__m128 y = _mm_loadu_ps(&rotations[1][lane]);
+		__m128 z = _mm_loadu_ps(&rotations[2][lane]);
+		__m128 w = _mm_loadu_ps(&rotations[3][lane]);
+		__m128 sx = _mm_loadu_ps(&scalings[0][lane]);
+		__m128 sy = _mm_loadu_ps(&scalings[1][lane]);
+		__m128 sz = _mm_loadu_ps(&scalings[2][lane]);
+		__m128 xx = _mm_mul_ps(x, x);
+		__m128 yy = _mm_mul_ps(y, y);
+		__m128 zz = _mm_mul_ps(z, z);
+		__m128 xy = _mm_mul_ps(x, y);
+		__m128 xz = _mm_mul_ps(x, z);
+		__m128 yz = _mm_mul_ps(y, z);
+		__m128 wx = _mm_mul_ps(w, x);
+		__m128 wy = _mm_mul_ps(w, y);
+		__m128 wz = _mm_mul_ps(w, z);
+		// One vector per matrix element, rotation columns scaled
+		__m128 rows[3][4];
+		rows[0][0] = _mm_mul_ps(
+			_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+		rows[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+		rows[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+		rows[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+		rows[1][1] = _mm_mul_ps(
+			_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+		rows[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+		rows[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+		rows[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+		rows[2][2] = _mm_mul_ps(
+			_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+		for (size_t row = 0; row < 3; row++) {
+			rows[row][3] = _mm_loadu_ps(&translations[row][lane]);
+			// Lanes to matrices, each row of the transposed block is a lane
+			_MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2],
+							  rows[row][3]);
+			for (size_t idx = 0; idx < 4; idx++)
+				_mm_storeu_ps(out[lane + idx].rows[row], rows[row][idx]);
+		}
+	}
+#else
+	(void)useSSE;
+#endif
+	for (; lane < count; lane++) {
+		float x = rotations[0][lane];
+		float y = rotations[1][lane];
+		float z = rotations[2][lane];
+		float w = rotations[3][lane];
+		float scaling[3] = {scalings[0][lane], scalings[1][lane],
+							scalings[2][lane]};
+		float rotation[3][3] = {
+			{1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z),
+			 2.0f * (x * z + w * y)},
+			{2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z),
+			 2.0f * (y * z - w * x)},
+			{2.0f * (x * z - w * y), 2.0f * (y * z + w * x),
+			 1.0f - 2.0f * (x * x + y * y)}};
+		for (size_t row = 0; row < 3; row++) {
+			for (size_t col = 0; col < 3; col++)
+				out[lane].rows[row][col] = rotation[row][col] * scaling[col];
+			out[lane].rows[row][3] = translations[row][lane];
+		}
+	}
+}
+
+void multiplyAffines(Affine const &lhs, Affine const &rhs, Affine &out,
+					 bool useSSE) {
+#if ANIMATION_KERNELS_SSE
+	if (useSSE) {
+		__m128 rhsRows[3] = {_mm_loadu_ps(rhs.rows[0]),
+							 _mm_loadu_ps(rhs.rows[1]),
+							 _mm_loadu_ps(rhs.rows[2])};
+		// The implied last row of rhs only adds the lhs translation
+		__m128 const lastRow = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		for (size_t row = 0; row < 3; row++) {
+			__m128 value =
+				_mm_mul_ps(_mm_set1_ps(lhs.rows[row][0]), rhsRows[0]);
+			value = _mm_add_ps(
+				value, _mm_mul_ps(_mm_set1_ps(lhs.rows[row][1]), rhsRows[1]));
+			value = _mm_add_ps(
+				value, _mm_mul_ps(_mm_set1_ps(lhs.rows[row][2]), rhsRows[2]));
+			value = _mm_add_ps(
+				value, _mm_mul_ps(_mm_set1_ps(lhs.rows[row][3]), lastRow));
+			_mm_storeu_ps(out.rows[row], value);
+		}
+		return;
+	}
+#else
+	(void)useSSE;
+#endif
+	Affine result;
+	for (size_t row = 0; row < 3; row++) {
+		for (size_t col = 0; col < 4; col++) {
+			result.rows[row][col] = lhs.rows[row][0] * rhs.rows[0][col] +
+									lhs.rows[row][1] * rhs.rows[1][col] +
+									lhs.rows[row][2] * rhs.rows[2][col];
+		}
+		result.rows[row][3] += lhs.rows[row][3];
+	}
+	out = result;
+}
+
+Affine toAffine(glm::mat4 const &matrix) {
+	Affine affine;
+	// glm matrices are column major
+	for (size_t row = 0; row < 3; row++) {
+		for (size_t col = 0; col < 4; col++)
+			affine.rows[row][col] = matrix[col][row];
+	}
+	return affine;
+}
+
+glm::mat4 toMat4(Affine const &affine) {
+	glm::mat4 matrix(1.0f);
+	for (size_t row = 0; row < 3; row++) {
+		for (size_t col = 0; col < 4; col++)
+			matrix[col][row] = affine.rows[row][col];
+	}
+	return matrix;
+}
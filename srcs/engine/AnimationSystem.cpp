@@ -0,0 +1,46 @@
+#include "engine/AnimationSystem.hpp"
+
+AnimationSystem::AnimationSystem(size_t threadCount)
+	: _threadPool(threadCount) {
+	for (size_t idx = 0; idx < _threadPool.getThreadCount(); idx++)
+		_batches.push_back(new PoseBatch());
+}
+
+AnimationSystem::~AnimationSystem(void) {
+	for (auto batch : _batches) delete batch;
+}
+
+void AnimationSystem::clear(void) { _entries.clear(); }
+
+void AnimationSystem::add(Model const *model, Pose *pose, double animTime) {
+	if (!model->needsSampling(animTime, *pose)) return;
+	Entry entry;
+	entry.model = model;
+	entry.pose = pose;
+	entry.animTime = animTime;
+	_entries.push_back(entry);
+}
+
+void AnimationSystem::sample(void) {
+	size_t taskCount = std::min(
+		_batches.size(),
+		(_entries.size() + ANIMATION_MIN_ENTITIES_PER_TASK - 1) /
+			ANIMATION_MIN_ENTITIES_PER_TASK);
+	if (taskCount == 0) return;
+	// Contiguous ranges, entities of a model often follow each other
+	for (size_t task = 0; task < taskCount; task++) {
+		PoseBatch *batch = _batches[task];
+		size_t begin = _entries.size() * task / taskCount;
+		size_t end = _entries.size() * (task + 1) / taskCount;
+		batch->clear();
+		for (size_t idx = begin; idx < end; idx++)
+			batch->add(_entries[idx].model, _entries[idx].pose,
+					   _entries[idx].animTime);
+	}
+	_threadPool.run(taskCount,
+					[this](size_t task) { _batches[task]->sample(); });
+}
+
+size_t AnimationSystem::getThreadCount(void) const {
+	return _threadPool.getThreadCount();
+}
@@ -0,0 +1,72 @@
+#include "engine/BroadphaseBenchmark.hpp"
+
+#include <iomanip>
+
+BroadphaseBenchmark::BroadphaseBenchmark(GameEngine &gameEngine)
+	: _gameEngine(gameEngine) {}
+
+BroadphaseBenchmark::~BroadphaseBenchmark(void) {}
+
+bool BroadphaseBenchmark::run(size_t tickCount) {
+	size_t measuredTicks = 0;
+	_gameEngine.setFastForward(true);
+	while (measuredTicks < tickCount) {
+		// run() returns once the tick limit is reached, then resumes
+		size_t tick = _gameEngine.getTickCount();
+		_gameEngine.setMaxTicks(tick + 1);
+		_gameEngine.run();
+		if (_gameEngine.getTickCount() == tick) break;  // The game ended
+		_measure();
+		measuredTicks++;
+	}
+	if (measuredTicks == 0) {
+		std::cerr << "\033[0;33m:Warning:\033[0m No tick was simulated"
+				  << std::endl;
+		return true;
+	}
+	std::cout << std::fixed << std::setprecision(1) << "Broadphase over "
+			  << measuredTicks << " ticks, "
+			  << static_cast<double>(_entityCount) / measuredTicks
+			  << " colliders per tick:" << std::endl;
+	std::cout << "  grid: "
+			  << static_cast<double>(_gridPairs) / measuredTicks
+			  << " pairs, " << std::setprecision(4)
+			  << _gridTime / measuredTicks << " ms per tick" << std::endl;
+	std::cout << std::setprecision(1) << "  linear: "
+			  << static_cast<double>(_linearPairs) / measuredTicks
+			  << " pairs, " << std::setprecision(4)
+			  << _linearTime / measuredTicks << " ms per tick" << std::endl;
+	std::cout << "  mismatches: " << _mismatches << std::endl;
+	return _mismatches == 0;
+}
+
+void BroadphaseBenchmark::_measure(void) {
+	typedef std::chrono::steady_clock BenchmarkClock;
+	auto byId = [](Entity *a, Entity *b) { return a->getId() < b->getId(); };
+	for (auto entity : _gameEngine.getAllEntities()) {
+		if (entity->getCollider() == nullptr || entity->needsToBeDestroyed())
+			continue;
+		for (int linearScan = 0; linearScan < 2; linearScan++) {
+			_collisions[linearScan].clear();
+			_triggers[linearScan].clear();
+		}
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		_gridPairs += _gameEngine.getCollisionCandidates(
+			entity, _collisions[0], _triggers[0], false);
+		BenchmarkClock::time_point middle = BenchmarkClock::now();
+		_linearPairs += _gameEngine.getCollisionCandidates(
+			entity, _collisions[1], _triggers[1], true);
+		BenchmarkClock::time_point end = BenchmarkClock::now();
+		_gridTime +=
+			std::chrono::duration<double, std::milli>(middle - start).count();
+		_linearTime +=
+			std::chrono::duration<double, std::milli>(end - middle).count();
+		_entityCount++;
+
+		// Grid candidates are sorted by id, the scan keeps the scene order
+		std::sort(_collisions[1].begin(), _collisions[1].end(), byId);
+		std::sort(_triggers[1].begin(), _triggers[1].end(), byId);
+		if (_collisions[0] != _collisions[1] || _triggers[0] != _triggers[1])
+			_mismatches++;
+	}
+}
@@ -35,6 +35,12 @@ Camera::~Camera(void) {}
 
 glm::mat4 const &Camera::getViewMatrix(void) const { return _view; };
 
+glm::mat4 Camera::getInterpolatedViewMatrix(float alpha) const {
+	// Moving the camera by 'offset' moves the world by '-offset'
+	glm::vec3 offset = getInterpolatedPosition(alpha) - getPosition();
+	return glm::translate(_view, -offset);
+}
+
 glm::mat4 const &Camera::getProjectionMatrix(void) const { return _projection; }
 
 void Camera::initEntity(GameEngine *gameEngine) {
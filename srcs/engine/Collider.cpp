@@ -1,15 +1,20 @@
 #include "engine/Collider.hpp"
 
 Collider::Collider(void)
-	: shape(Collider::Rectangle), width(1), height(1), isTrigger(false) {}
+	: shape(Collider::Rectangle),
+	  width(1),
+	  height(1),
+	  isTrigger(false),
+	  isStatic(false) {}
 
 Collider::Collider(Shape shape, int layerTag, float width, float height,
-				   bool isTrigger)
+				   bool isTrigger, bool isStatic)
 	: shape(shape),
 	  layerTag(layerTag),
 	  width(width),
 	  height(height),
-	  isTrigger(isTrigger) {}
+	  isTrigger(isTrigger),
+	  isStatic(isStatic) {}
 
 Collider::Collider(Collider const &src) { *this = src; }
 
@@ -18,6 +23,7 @@ Collider::~Collider(void) {}
 Collider &Collider::operator=(Collider const &rhs) {
 	this->shape = rhs.shape;
 	this->isTrigger = rhs.isTrigger;
+	this->isStatic = rhs.isStatic;
 	this->height = rhs.height;
 	this->width = rhs.width;
 	return *this;
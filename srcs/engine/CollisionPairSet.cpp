@@ -0,0 +1,104 @@
+#include "engine/CollisionPairSet.hpp"
+
+CollisionPair::CollisionPair(size_t idA, size_t idB)
+	: first(std::min(idA, idB)), second(std::max(idA, idB)) {}
+
+bool CollisionPair::operator==(CollisionPair const &rhs) const {
+	return first == rhs.first && second == rhs.second;
+}
+
+size_t CollisionPairHash::operator()(CollisionPair const &pair) const {
+	size_t seed = std::hash<size_t>()(pair.first);
+	return seed ^ (std::hash<size_t>()(pair.second) + 0x9e3779b9 +
+				   (seed << 6) + (seed >> 2));
+}
+
+CollisionPairSet::CollisionPairSet(void) {}
+
+CollisionPairSet::~CollisionPairSet(void) {}
+
+void CollisionPairSet::insert(size_t idA, size_t idB) {
+	// An entity never collides with itself
+	if (idA == idB) return;
+	CollisionPair pair(idA, idB);
+	if (_indices.find(pair) != _indices.end()) return;
+	size_t slot = _pairs.size();
+	std::vector<size_t> &firstPairs = _entityPairs[pair.first];
+	std::vector<size_t> &secondPairs = _entityPairs[pair.second];
+	PairLinks links;
+	links.first = firstPairs.size();
+	links.second = secondPairs.size();
+	firstPairs.push_back(slot);
+	secondPairs.push_back(slot);
+	_indices[pair] = slot;
+	_pairs.push_back(pair);
+	_links.push_back(links);
+}
+
+bool CollisionPairSet::contains(size_t idA, size_t idB) const {
+	if (_pairs.empty()) return false;
+	return _indices.find(CollisionPair(idA, idB)) != _indices.end();
+}
+
+void CollisionPairSet::erase(size_t idA, size_t idB) {
+	auto it = _indices.find(CollisionPair(idA, idB));
+	if (it != _indices.end()) _eraseAt(it->second);
+}
+
+void CollisionPairSet::eraseAll(size_t id) {
+	// The list goes away with the last pair of this entity
+	auto entityPairs = _entityPairs.find(id);
+	while (entityPairs != _entityPairs.end()) {
+		_eraseAt(entityPairs->second.back());
+		entityPairs = _entityPairs.find(id);
+	}
+}
+
+void CollisionPairSet::clear(void) {
+	_pairs.clear();
+	_links.clear();
+	_indices.clear();
+	_entityPairs.clear();
+}
+
+bool CollisionPairSet::empty(void) const { return _pairs.empty(); }
+
+size_t CollisionPairSet::size(void) const { return _pairs.size(); }
+
+CollisionPair const &CollisionPairSet::operator[](size_t idx) const {
+	return _pairs[idx];
+}
+
+void CollisionPairSet::_eraseAt(size_t idx) {
+	CollisionPair pair = _pairs[idx];
+	_indices.erase(pair);
+	_unlink(pair.first, _links[idx].first);
+	_unlink(pair.second, _links[idx].second);
+	// Keep the storage dense, the lists of the moved pair follow it
+	if (idx != _pairs.size() - 1) {
+		_pairs[idx] = _pairs.back();
+		_links[idx] = _links.back();
+		_indices[_pairs[idx]] = idx;
+		_entityPairs[_pairs[idx].first][_links[idx].first] = idx;
+		_entityPairs[_pairs[idx].second][_links[idx].second] = idx;
+	}
+	_pairs.pop_back();
+	_links.pop_back();
+}
+
+void CollisionPairSet::_unlink(size_t id, size_t link) {
+	auto entityPairs = _entityPairs.find(id);
+	std::vector<size_t> &slots = entityPairs->second;
+	// Swap and pop, the moved slot gets told its new position
+	if (link != slots.size() - 1) {
+		slots[link] = slots.back();
+		_getLink(slots[link], id) = link;
+	}
+	slots.pop_back();
+	if (slots.empty()) _entityPairs.erase(entityPairs);
+}
+
+size_t &CollisionPairSet::_getLink(size_t slot, size_t id) {
+	return _pairs[slot].first == id ? _links[slot].first
+									: _links[slot].second;
+}
@@ -0,0 +1,81 @@
+#include "engine/DynamicResolution.hpp"
+
+DynamicResolution::DynamicResolution(void) {}
+
+DynamicResolution::~DynamicResolution(void) {}
+
+void DynamicResolution::init(void) {
+	release();
+	glGenQueries(DYNAMIC_RESOLUTION_QUERIES, _queries);
+}
+
+void DynamicResolution::release(void) {
+	if (_queries[0]) glDeleteQueries(DYNAMIC_RESOLUTION_QUERIES, _queries);
+	for (auto &query : _queries) query = 0;
+	for (auto &isPending : _isPending) isPending = false;
+	_isMeasuring = false;
+}
+
+void DynamicResolution::reset(float maxScale, bool isEnabled) {
+	_maxScale = maxScale;
+	_scale = maxScale;
+	_isEnabled = isEnabled;
+	_cooldown = DYNAMIC_RESOLUTION_COOLDOWN;
+}
+
+void DynamicResolution::beginFrame(void) {
+	_readResults();
+	// Every query still waits for the GPU, skip this frame
+	if (_isPending[_current]) return;
+	glBeginQuery(GL_TIME_ELAPSED, _queries[_current]);
+	_isMeasuring = true;
+}
+
+void DynamicResolution::endFrame(void) {
+	if (!_isMeasuring) return;
+	glEndQuery(GL_TIME_ELAPSED);
+	_isMeasuring = false;
+	_isPending[_current] = true;
+	_current = (_current + 1) % DYNAMIC_RESOLUTION_QUERIES;
+}
+
+float DynamicResolution::getScale(void) const { return _scale; }
+
+float DynamicResolution::getGPUTime(void) const { return _gpuTime; }
+
+void DynamicResolution::_readResults(void) {
+	// Oldest query first, they complete in order
+	for (size_t offset = 0; offset < DYNAMIC_RESOLUTION_QUERIES; offset++) {
+		size_t idx = (_current + offset) % DYNAMIC_RESOLUTION_QUERIES;
+		if (!_isPending[idx]) continue;
+		GLint isAvailable = GL_FALSE;
+		glGetQueryObjectiv(_queries[idx], GL_QUERY_RESULT_AVAILABLE,
+						   &isAvailable);
+		if (!isAvailable) break;
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(_queries[idx], GL_QUERY_RESULT, &elapsed);
+		_isPending[idx] = false;
+		float gpuTime = static_cast<float>(elapsed) / 1000000.0f;
+		_gpuTime =
+			(_gpuTime == 0.0f) ? gpuTime : glm::mix(_gpuTime, gpuTime, 0.1f);
+		_adjustScale();
+	}
+}
+
+void DynamicResolution::_adjustScale(void) {
+	if (!_isEnabled) return;
+	if (_cooldown > 0) {
+		_cooldown--;
+		return;
+	}
+	float scale = _scale;
+	if (_gpuTime > DYNAMIC_RESOLUTION_TARGET)
+		scale = std::max(_scale - DYNAMIC_RESOLUTION_STEP,
+						 std::min(DYNAMIC_RESOLUTION_MIN_SCALE, _maxScale));
+	else if (_gpuTime < DYNAMIC_RESOLUTION_TARGET * DYNAMIC_RESOLUTION_HEADROOM)
+		scale = std::min(_scale + DYNAMIC_RESOLUTION_STEP, _maxScale);
+	if (scale != _scale) {
+		_scale = scale;
+		_cooldown = DYNAMIC_RESOLUTION_COOLDOWN;
+	}
+}
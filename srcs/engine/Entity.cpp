@@ -26,6 +26,7 @@ Entity::Entity(glm::vec3 position, glm::vec3 eulerAngles, Collider *collider,
 	_rotationMatrix = glm::mat4(glm::quat(glm::radians(eulerAngles)));
 	_eulerAngles = eulerAngles;
 	_updateModelMatrix();
+	_previousPosition = _position;
 
 	// Signal, if _sceneManager is set, where is entity starting pos
 	if (_sceneManager != nullptr) _sceneManager->tellPosition(this);
@@ -58,8 +59,25 @@ const glm::vec3 &Entity::getPosition(void) const { return _position; }
 
 const glm::vec3 &Entity::getColor(void) const { return _color; }
 
+Pose &Entity::getPose(void) { return _pose; }
+
 const glm::mat4 &Entity::getModelMatrix(void) const { return _modelMatrix; }
 
+glm::vec3 Entity::getInterpolatedPosition(float alpha) const {
+	return glm::mix(_previousPosition, _position, alpha);
+}
+
+glm::mat4 Entity::getInterpolatedModelMatrix(float alpha) const {
+	// Only position is interpolated, rotations and scales are never big
+	// enough between two ticks to be noticed
+	glm::mat4 modelMatrix = _modelMatrix;
+	glm::vec3 position = getInterpolatedPosition(alpha);
+	modelMatrix[3][0] = position.x;
+	modelMatrix[3][1] = position.y;
+	modelMatrix[3][2] = position.z;
+	return modelMatrix;
+}
+
 const Collider *Entity::getCollider(void) const { return _collider; }
 
 Model *Entity::getModel(void) const { return _model; }
@@ -92,6 +110,8 @@ std::set<std::string> Entity::getNeededSounds(void) const {
 
 bool Entity::doShowModel(void) const { return _showModel; }
 
+void Entity::savePreviousPosition(void) { _previousPosition = _position; }
+
 void Entity::setColor(glm::vec3 const &color) { _color = color; }
 
 void Entity::resetColor(void) { _color = glm::vec3(-1.0f); }
@@ -100,6 +120,10 @@ void Entity::translate(glm::vec3 translation) {
 	_translationMatrix = glm::translate(_translationMatrix, translation);
 	_updateModelMatrix();
 
+	// Keep collision broadphase up to date
+	if (_gameEngine != nullptr && _collider != nullptr)
+		_gameEngine->tellPosition(this);
+
 	// Signal, if _sceneManager is set, what is the entity new position
 	if (_sceneManager != nullptr) _sceneManager->tellPosition(this);
 }
@@ -143,6 +167,8 @@ void Entity::_updateModelMatrix(void) {
 void Entity::initEntity(GameEngine *gameEngine) {
 	_gameEngine = gameEngine;
 	updateModel();
+	// Do not interpolate from where the entity was before being spawned
+	_previousPosition = _position;
 	if (_initSounds.size() != 0) {
 		gameEngine->playSound(_initSounds[rand() % _initSounds.size()]);
 	}
@@ -0,0 +1,81 @@
+#include "engine/EntityRegistry.hpp"
+
+EntityHandle::EntityHandle(void) : index(0), generation(0) {}
+
+EntityHandle::EntityHandle(uint32_t index, uint32_t generation)
+	: index(index), generation(generation) {}
+
+bool EntityHandle::isNull(void) const { return generation == 0; }
+
+bool EntityHandle::operator==(EntityHandle const &rhs) const {
+	return index == rhs.index && generation == rhs.generation;
+}
+
+bool EntityHandle::operator!=(EntityHandle const &rhs) const {
+	return !(*this == rhs);
+}
+
+EntityRegistry::EntityRegistry(void) {}
+
+EntityRegistry::~EntityRegistry(void) {}
+
+EntityHandle EntityRegistry::add(Entity *entity) {
+	auto it = _slotsById.find(entity->getId());
+	if (it != _slotsById.end() && _slots[it->second].entity == entity)
+		return EntityHandle(it->second, _slots[it->second].generation);
+
+	uint32_t index;
+	if (_freeSlots.empty()) {
+		index = static_cast<uint32_t>(_slots.size());
+		_slots.push_back(Slot{nullptr, 0});
+	} else {
+		index = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	Slot &slot = _slots[index];
+	slot.entity = entity;
+	// Skip 0 so that a default handle never resolves
+	if (++slot.generation == 0) slot.generation = 1;
+	_slotsById[entity->getId()] = index;
+	return EntityHandle(index, slot.generation);
+}
+
+void EntityRegistry::remove(Entity *entity) {
+	auto it = _slotsById.find(entity->getId());
+	if (it == _slotsById.end() || _slots[it->second].entity != entity) return;
+	// Old handles now point to a dead generation
+	_slots[it->second].entity = nullptr;
+	_freeSlots.push_back(it->second);
+	_slotsById.erase(it);
+}
+
+void EntityRegistry::clear(void) {
+	// Keep generations so that handles from the previous scene stay stale
+	_freeSlots.clear();
+	for (uint32_t index = static_cast<uint32_t>(_slots.size()); index-- > 0;) {
+		_slots[index].entity = nullptr;
+		_freeSlots.push_back(index);
+	}
+	_slotsById.clear();
+}
+
+Entity *EntityRegistry::get(EntityHandle const &handle) const {
+	if (handle.isNull() || handle.index >= _slots.size()) return nullptr;
+	Slot const &slot = _slots[handle.index];
+	return slot.generation == handle.generation ? slot.entity : nullptr;
+}
+
+Entity *EntityRegistry::getById(size_t id) const {
+	auto it = _slotsById.find(id);
+	return it == _slotsById.end() ? nullptr : _slots[it->second].entity;
+}
+
+EntityHandle EntityRegistry::getHandle(Entity *entity) const {
+	if (entity == nullptr) return EntityHandle();
+	auto it = _slotsById.find(entity->getId());
+	if (it == _slotsById.end() || _slots[it->second].entity != entity)
+		return EntityHandle();
+	return EntityHandle(it->second, _slots[it->second].generation);
+}
+
+size_t EntityRegistry::size(void) const { return _slotsById.size(); }
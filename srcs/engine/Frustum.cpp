@@ -0,0 +1,62 @@
+#include "engine/Frustum.hpp"
+
+Frustum::Frustum(glm::mat4 const &viewProjection) {
+	// Rows of the matrix, glm is column major
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+							  viewProjection[2][row], viewProjection[3][row]);
+	_planes[0] = rows[3] + rows[0];  // Left
+	_planes[1] = rows[3] - rows[0];  // Right
+	_planes[2] = rows[3] + rows[1];  // Bottom
+	_planes[3] = rows[3] - rows[1];  // Top
+	_planes[4] = rows[3] + rows[2];  // Near
+	_planes[5] = rows[3] - rows[2];  // Far
+	for (auto &plane : _planes)
+		plane /= glm::length(glm::vec3(plane.x, plane.y, plane.z));
+}
+
+Frustum::~Frustum(void) {}
+
+bool Frustum::intersectsSphere(glm::vec3 const &center, float radius) const {
+	for (auto const &plane : _planes) {
+		if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), center) + plane.w <
+			-radius)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::intersectsBox(glm::vec3 const &center,
+							glm::vec3 const &halfExtents) const {
+	for (auto const &plane : _planes) {
+		glm::vec3 normal(plane.x, plane.y, plane.z);
+		float reach = glm::dot(glm::abs(normal), halfExtents);
+		if (glm::dot(normal, center) + plane.w < -reach) return false;
+	}
+	return true;
+}
+
+bool Frustum::isVisible(Bounds const &bounds, glm::mat4 const &model) const {
+	glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+						   std::max(glm::length(glm::vec3(model[1])),
+									glm::length(glm::vec3(model[2]))));
+	if (!intersectsSphere(center, bounds.radius * scale)) return false;
+
+	glm::vec3 boxCenter;
+	glm::vec3 halfExtents;
+	getWorldBox(bounds, model, boxCenter, halfExtents);
+	return intersectsBox(boxCenter, halfExtents);
+}
+
+void Frustum::getWorldBox(Bounds const &bounds, glm::mat4 const &model,
+						  glm::vec3 &center, glm::vec3 &halfExtents) {
+	// World extents of the rotated box are |M| * local extents
+	center =
+		glm::vec3(model * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+	glm::vec3 localExtents = (bounds.max - bounds.min) * 0.5f;
+	halfExtents = glm::vec3(0.0f);
+	for (int column = 0; column < 3; column++)
+		halfExtents += glm::abs(glm::vec3(model[column])) * localExtents[column];
+}
@@ -0,0 +1,92 @@
+#include "engine/GLState.hpp"
+
+GLState::GLState(void) { invalidate(); }
+
+GLState::~GLState(void) {}
+
+void GLState::useProgram(GLuint program) {
+	if (_update(_program, program)) glUseProgram(program);
+}
+
+void GLState::bindVertexArray(GLuint vertexArray) {
+	if (_update(_vertexArray, vertexArray)) glBindVertexArray(vertexArray);
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+	int targetIdx = _getTargetIndex(target);
+	if (unit < GL_STATE_TEXTURE_UNITS && targetIdx != -1 &&
+		!_update(_textures[unit][targetIdx], texture))
+		return;
+	if (unit >= GL_STATE_TEXTURE_UNITS || targetIdx == -1) _issuedCount++;
+	// Only the bind was requested, the unit switch is not counted
+	if (_activeUnit != unit) {
+		_activeUnit = unit;
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+	glBindTexture(target, texture);
+}
+
+void GLState::enable(GLenum capability) { _setCapability(capability, true); }
+
+void GLState::disable(GLenum capability) { _setCapability(capability, false); }
+
+void GLState::cullFace(GLenum mode) {
+	if (_update(_cullFaceMode, mode)) glCullFace(mode);
+}
+
+void GLState::depthFunc(GLenum func) {
+	if (_update(_depthFunc, func)) glDepthFunc(func);
+}
+
+void GLState::invalidate(void) {
+	_program = GL_STATE_UNKNOWN;
+	_vertexArray = GL_STATE_UNKNOWN;
+	_activeUnit = GL_STATE_UNKNOWN;
+	for (size_t unit = 0; unit < GL_STATE_TEXTURE_UNITS; unit++) {
+		for (size_t target = 0; target < TextureTargetCount; target++)
+			_textures[unit][target] = GL_STATE_UNKNOWN;
+	}
+	_cullFaceMode = GL_STATE_UNKNOWN;
+	_depthFunc = GL_STATE_UNKNOWN;
+	_capabilities.clear();
+}
+
+void GLState::resetCounters(void) {
+	_issuedCount = 0;
+	_skippedCount = 0;
+}
+
+size_t GLState::getIssuedCount(void) const { return _issuedCount; }
+
+size_t GLState::getSkippedCount(void) const { return _skippedCount; }
+
+bool GLState::_update(GLuint &cached, GLuint value) {
+	if (cached == value) {
+		_skippedCount++;
+		return false;
+	}
+	cached = value;
+	_issuedCount++;
+	return true;
+}
+
+void GLState::_setCapability(GLenum capability, bool isEnabled) {
+	auto it = _capabilities.find(capability);
+	if (it != _capabilities.end() && it->second == isEnabled) {
+		_skippedCount++;
+		return;
+	}
+	_capabilities[capability] = isEnabled;
+	_issuedCount++;
+	if (isEnabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+int GLState::_getTargetIndex(GLenum target) {
+	if (target == GL_TEXTURE_2D) return Texture2D;
+	if (target == GL_TEXTURE_2D_ARRAY) return Texture2DArray;
+	if (target == GL_TEXTURE_CUBE_MAP) return TextureCubeMap;
+	return -1;
+}
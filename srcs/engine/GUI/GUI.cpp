@@ -156,16 +156,16 @@ void GUI::nkRender() {
 	ortho[1][1] /= (GLfloat)GUI::glfw.height;
 
 	// Setup global state
-	glEnable(GL_BLEND);
+	GLState &glState = _gameRenderer->getGLState();
+	glState.enable(GL_BLEND);
 	glBlendEquation(GL_FUNC_ADD);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_SCISSOR_TEST);
-	glActiveTexture(GL_TEXTURE0);
+	glState.disable(GL_CULL_FACE);
+	glState.disable(GL_DEPTH_TEST);
+	glState.enable(GL_SCISSOR_TEST);
 
 	// Setup program
-	glUseProgram(dev->prog);
+	glState.useProgram(dev->prog);
 	glUniform1i(dev->uniform_tex, 0);
 	glUniformMatrix4fv(dev->uniform_proj, 1, GL_FALSE, &ortho[0][0]);
 	glViewport(0, 0, (GLsizei)GUI::glfw.display_width,
@@ -177,7 +177,7 @@ void GUI::nkRender() {
 		const nk_draw_index *offset = NULL;
 
 		// Allocate vertex and element buffer
-		glBindVertexArray(dev->vao);
+		glState.bindVertexArray(dev->vao);
 		glBindBuffer(GL_ARRAY_BUFFER, dev->vbo);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dev->ebo);
 
@@ -222,7 +222,7 @@ void GUI::nkRender() {
 		// Iterate over and execute each draw command
 		nk_draw_foreach(cmd, &GUI::glfw.ctx, &dev->cmds) {
 			if (!cmd->elem_count) continue;
-			glBindTexture(GL_TEXTURE_2D, (GLuint)cmd->texture.id);
+			glState.bindTexture(0, GL_TEXTURE_2D, (GLuint)cmd->texture.id);
 			glScissor((GLint)(cmd->clip_rect.x * GUI::glfw.fb_scale.x),
 					  (GLint)((GUI::glfw.height -
 							   (GLint)(cmd->clip_rect.y + cmd->clip_rect.h)) *
@@ -236,13 +236,8 @@ void GUI::nkRender() {
 		nk_clear(&GUI::glfw.ctx);
 	}
 
-	// Default OpenGL state
-	glUseProgram(0);
+	// Bindings and capabilities are left to the next user of the GLState
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-	glDisable(GL_BLEND);
-	glDisable(GL_SCISSOR_TEST);
 }
 
 // Init font
@@ -3,25 +3,6 @@
 
 // std::thread *_loadSceneThread = nullptr;
 
-GameEngine::LineInfo::LineInfo(void)
-	: m(0.0f),
-	  q(0.0f),
-	  isVertical(false),
-	  startX(0.0f),
-	  startZ(0.0f),
-	  endX(0.0f),
-	  endZ(0.0f) {}
-
-GameEngine::LineInfo::LineInfo(float startX, float startZ, float endX,
-							   float endZ)
-	: startX(startX), startZ(startZ), endX(endX), endZ(endZ) {
-	isVertical = startX == endX;
-	if (!isVertical) {
-		m = (startZ - endZ) / (startX - endX);
-		q = startZ - m * startX;
-	}
-}
-
 GameEngine::RectanglePoints::RectanglePoints(Entity *entity,
 											 glm::vec3 movement) {
 	top = entity->getPosition().z - entity->getCollider()->height;
@@ -45,18 +26,23 @@ GameEngine::RectanglePoints::RectanglePoints(Entity *entity,
 	right += EPSILON;
 }
 
-GameEngine::GameEngine(AGame *game)
-	: _game(game), _collisionTable(game->getCollisionTable()) {
+GameEngine::GameEngine(AGame *game, bool headless)
+	: _headless(headless),
+	  _game(game),
+	  _collisionMasks(game->getCollisionMasks()) {
 	// Create interface class
-	_gameRenderer = new GameRenderer(this, _game);
+	_gameRenderer = new GameRenderer(this, _game, _headless);
 	_game->setGameRenderer(_gameRenderer);
-	// Create audio manager
-	_audioManager = new AudioManager(_game->getStartingMusicVolume(),
-									 _game->getStartingSoundsVolume());
-	_game->setAudioManager(_audioManager);
+	// Create audio manager, a headless simulation stays silent
+	if (!_headless) {
+		_audioManager = new AudioManager(_game->getStartingMusicVolume(),
+										 _game->getStartingSoundsVolume());
+		_game->setAudioManager(_audioManager);
+	}
 
 	// Force load of first scene
 	_sceneIdx = _game->getFirstSceneIdx();
+	setTickRate(_game->getTickRate());
 
 	// Thread atomic Int
 	_sceneState = BACKGROUND_LOAD_NEEDED;
@@ -70,21 +56,157 @@ GameEngine::~GameEngine(void) {
 	if (_sceneState != BACKGROUND_LOAD_STARTED) {
 		_unloadScene();
 	}
-	delete _audioManager;
+	if (_audioManager) delete _audioManager;
 	delete _gameRenderer;
 }
 
 float GameEngine::getDeltaTime(void) { return _deltaTime; }
 
+float GameEngine::getTickRate(void) const { return _tickRate; }
+
+float GameEngine::getInterpolationAlpha(void) const {
+	return _interpolationAlpha;
+}
+
+void GameEngine::setTickRate(float tickRate) {
+	if (tickRate <= 0.0f) {
+		std::cerr << "\033[0;33m:Warning:\033[0m Invalid tick rate "
+				  << tickRate << ", keeping " << _tickRate << std::endl;
+		return;
+	}
+	_tickRate = tickRate;
+}
+
+bool GameEngine::setFirstScene(std::string const &sceneName) {
+	int sceneIdx = _game->getSceneIndexByName(sceneName);
+	if (sceneIdx == -1) {
+		std::cerr << "\033[0;33m:Warning:\033[0m Unknown scene \"" << sceneName
+				  << "\", keeping the default one" << std::endl;
+		return false;
+	}
+	_sceneIdx = sceneIdx;
+	return true;
+}
+
+void GameEngine::setFastForward(bool fastForward) {
+	_fastForward = fastForward;
+}
+
+void GameEngine::setMaxTicks(size_t maxTicks) { _maxTicks = maxTicks; }
+
+void GameEngine::setInputScript(std::vector<ScriptedInput> const &inputScript) {
+	_inputScript = inputScript;
+	std::stable_sort(_inputScript.begin(), _inputScript.end(),
+					 [](ScriptedInput const &lhs, ScriptedInput const &rhs) {
+						 return lhs.tick < rhs.tick;
+					 });
+	_inputScriptIdx = 0;
+	while (_inputScriptIdx < _inputScript.size() &&
+		   _inputScript[_inputScriptIdx].tick < _tickCount)
+		_inputScriptIdx++;
+}
+
+std::vector<ScriptedInput> GameEngine::loadInputScript(
+	std::string const &path) {
+	// One event per line: <tick> <key> <press|release>, '#' starts a comment
+	std::ifstream file(path);
+	if (!file.is_open())
+		throw std::runtime_error(
+			"\033[0;31m:Error:\033[0m Cannot open input script " + path);
+	std::vector<ScriptedInput> inputScript;
+	std::string line;
+	size_t lineNbr = 0;
+	while (std::getline(file, line)) {
+		lineNbr++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) line.erase(comment);
+		std::istringstream stream(line);
+		std::string tick, key, state;
+		if (!(stream >> tick)) continue;  // Empty line
+		ScriptedInput input;
+		char *end = nullptr;
+		input.tick = strtoul(tick.c_str(), &end, 10);
+		bool isValid = *end == '\0' && (stream >> key >> state);
+		if (isValid) {
+			input.keyID = _parseKeyName(key);
+			isValid = input.keyID != KEY_UNKNOWN;
+		}
+		if (isValid) {
+			isValid = state == "press" || state == "1" || state == "release" ||
+					  state == "0";
+			input.isPressed = state == "press" || state == "1";
+		}
+		if (!isValid) {
+			std::cerr << "\033[0;33m:Warning:\033[0m Invalid input script line "
+					  << lineNbr << " in " << path << std::endl;
+			continue;
+		}
+		inputScript.push_back(input);
+	}
+	return inputScript;
+}
+
+int GameEngine::_parseKeyName(std::string const &keyName) {
+	static const std::map<std::string, int> namedKeys = {
+		{"SPACE", KEY_SPACE}, {"ESCAPE", KEY_ESCAPE}, {"ENTER", KEY_ENTER},
+		{"TAB", KEY_TAB},     {"LEFT", KEY_LEFT},     {"RIGHT", KEY_RIGHT},
+		{"UP", KEY_UP},       {"DOWN", KEY_DOWN}};
+	if (keyName.empty()) return KEY_UNKNOWN;
+	auto it = namedKeys.find(keyName);
+	if (it != namedKeys.end()) return it->second;
+	// Letters and digits share their ASCII code with GLFW
+	if (keyName.size() == 1 && isalnum(keyName[0]))
+		return toupper(keyName[0]);
+	char *end = nullptr;
+	long keyID = strtol(keyName.c_str(), &end, 10);
+	if (*end != '\0' || keyID < 0 || keyID > GLFW_KEY_LAST) return KEY_UNKNOWN;
+	return static_cast<int>(keyID);
+}
+
+bool GameEngine::isHeadless(void) const { return _headless; }
+
+size_t GameEngine::getTickCount(void) const { return _tickCount; }
+
+Profiler &GameEngine::getProfiler(void) { return _profiler; }
+
+std::vector<Entity *> const &GameEngine::getAllEntities(void) const {
+	return _allEntities;
+}
+
+size_t GameEngine::getCollisionCandidates(
+	Entity *entity, std::vector<Entity *> &possibleCollisions,
+	std::vector<Entity *> &possibleTriggers, bool linearScan) {
+	// Same query as a move: only triggers look at the static tiles
+	bool withStaticTiles = entity->getCollider()->isTrigger;
+	if (linearScan) {
+		_getPossibleCollisionsLinear(entity, possibleCollisions,
+									 possibleTriggers, withStaticTiles);
+		return _allEntities.size();
+	}
+	_getPossibleCollisions(entity, possibleCollisions, possibleTriggers,
+						   withStaticTiles);
+	return _broadphaseCandidates.size();
+}
+
 GameRenderer const *GameEngine::getGameRenderer(void) const {
 	return _gameRenderer;
 }
 
 void GameEngine::addNewEntity(Entity *entity) {
 	_newEntities.push_back(entity);
+	_entityRegistry.add(entity);
 	_newEntities.back()->initEntity(this);
 }
 
+void GameEngine::tellPosition(Entity *entity) {
+	// Moved tiles may not be grid aligned anymore
+	if (_tileLayer.contains(entity)) {
+		_tileLayer.remove(entity);
+		_registerCollider(entity);
+	} else
+		_spatialGrid.update(entity);
+}
+
 void GameEngine::run(void) {
 	if (_sceneState == BACKGROUND_LOAD_NEEDED) {
 		_sceneState = BACKGROUND_LOAD_STARTED;
@@ -93,6 +215,7 @@ void GameEngine::run(void) {
 		_light = _loadingLight;
 		_skybox = _loadingSkybox;
 		_allEntities = _loadingAllEntities;
+		for (auto entity : _allEntities) _entityRegistry.add(entity);
 
 		// Init thread to load the scene we want
 		_checkLoadSceneIsGood = false;
@@ -101,7 +224,9 @@ void GameEngine::run(void) {
 							&_sceneState, &_checkLoadSceneIsGood);
 
 		// Wait for other thread to finish
+		_interpolationAlpha = 1.0f;
 		while (_sceneState != BACKGROUND_LOAD_FINISHED) {
+			_rollKeysOver();
 			_gameRenderer->getUserInput();
 			_camera->update();
 			for (auto entity : _allEntities) {
@@ -109,6 +234,8 @@ void GameEngine::run(void) {
 			}
 			_gameRenderer->refreshWindow(_allEntities, _camera, _light,
 										 _skybox);
+			if (_headless)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
 		// Free thread
 		_loadSceneThread->join();
@@ -126,140 +253,60 @@ void GameEngine::run(void) {
 
 	// Start game loop
 	int newSceneIdx = -1;
+	double tickDuration;
+	double accumulator = 0.0;
+	bool isRunning = true;
 	_lastFrameTs = Clock::now();
-	while (true) {
-		// Get delta time in order to synch entities positions
+	while (isRunning) {
+		_profiler.beginFrame();
+		// Get frame time, the simulation itself only moves by fixed ticks
 		_frameTs = Clock::now();
-		_deltaTime = (std::chrono::duration_cast<std::chrono::microseconds>(
-						  _frameTs - _lastFrameTs)
-						  .count()) /
-					 1000000.0f;
+		_frameDeltaTime =
+			(std::chrono::duration_cast<std::chrono::microseconds>(
+				 _frameTs - _lastFrameTs)
+				 .count()) /
+			1000000.0f;
 		_lastFrameTs = _frameTs;
-
-		// Update inputs
-		for (auto &key : _keyboardMap)
-			key.second.prevFrame = key.second.currFrame;
-
+		tickDuration = 1.0 / _tickRate;
+		// Fast forward ignores wall time and runs one tick per iteration
+		if (_fastForward)
+			accumulator = tickDuration;
+		else
+			accumulator = std::min(accumulator + _frameDeltaTime,
+								   tickDuration * MAX_TICKS_PER_FRAME);
+
+		_profiler.start(PhaseInput);
+		_rollKeysOver();
 		_gameRenderer->getUserInput();
-
-		// Update game camera
-		_camera->update();
-		newSceneIdx = _camera->getNewSceneIdx();
-		if (newSceneIdx != -1) break;
-		newSceneIdx = _game->getSceneIndexByName(_camera->getNewSceneName());
-		if (newSceneIdx != -1) break;
-
-		if (!_camera->isGameRunning()) break;
-
-		// Freeze everything else if camera tells so
-		if (!_camera->isPause()) {
-			if (_light) _light->update();
-			// Update game entities states
-			for (auto entity : _allEntities) {
-				entity->update();
-			}
-
-			// Merge new game entities
-			if (!_newEntities.empty()) {
-				std::vector<Entity *> collidedEntities;
-				std::vector<Entity *>
-					triggeredEntities;  // We dont really use this vector,
-										// it's just needed by func
-				std::vector<Entity *> entitiesToTest = _allEntities;
-				entitiesToTest.insert(entitiesToTest.end(),
-									  _newEntities.begin(), _newEntities.end());
-				std::vector<size_t> initialCollisions;
-				for (auto newEntity : _newEntities) {
-					if (newEntity->getCollider() == nullptr ||
-						newEntity->getCollider()->isTrigger)
-						continue;
-					collidedEntities.clear();
-					initialCollisions.clear();
-					_getPossibleCollisions(newEntity, collidedEntities,
-										   triggeredEntities, entitiesToTest);
-					// Possible collision that have been detected are sure to
-					// collide since newEntities do not have any targetMovement
-					// yet
-					if (!collidedEntities.empty()) {
-						for (auto collidedEntity : collidedEntities) {
-							if (_doCollide(newEntity->getCollider(),
-										   newEntity->getPosition(),
-										   collidedEntity)) {
-								initialCollisions.push_back(
-									collidedEntity->getId());
-								// Add for other entity too
-								_initialCollisionMap[collidedEntity->getId()]
-									.push_back(newEntity->getId());
-							}
-						}
-						if (!initialCollisions.empty())
-							_initialCollisionMap[newEntity->getId()] =
-								initialCollisions;
-					}
-				}
-				_allEntities.insert(_allEntities.end(), _newEntities.begin(),
-									_newEntities.end());
-				_newEntities.clear();
-			}
-
-			// Do movement (with collisions + trigger detection)
-			_moveEntities();
-
-			// Delete game entities if needed
-			for (size_t idx = _allEntities.size() - 1;
-				 idx < _allEntities.size(); idx--) {
-				if (_allEntities[idx]->needsToBeDestroyed()) {
-					// Erase possible ingame ref
-					if (_initialCollisionMap.find(_allEntities[idx]->getId()) !=
-						_initialCollisionMap.end())
-						_initialCollisionMap.erase(_allEntities[idx]->getId());
-					for (auto &initialCollisions : _initialCollisionMap) {
-						for (size_t idIdx = 0;
-							 idIdx < initialCollisions.second.size(); idIdx++) {
-							if (initialCollisions.second[idIdx] ==
-								_allEntities[idx]->getId())
-								initialCollisions.second.erase(
-									initialCollisions.second.begin() + idIdx);
-						}
-					}
-					delete _allEntities[idx];
-					_allEntities.erase(_allEntities.begin() + idx);
-				}
-			}
-
-			// Check if there are changes for _initialCollisionMap
-			if (!_initialCollisionMap.empty()) {
-				std::vector<size_t> idxToDelete;
-				Entity *entityA;
-				// Entity *entityB;
-				for (auto &initialCollisions : _initialCollisionMap) {
-					entityA = getEntityById(initialCollisions.first);
-					// Just to be sure
-					if (entityA == nullptr) {
-						idxToDelete.push_back(initialCollisions.first);
-						continue;
-					}
-					for (size_t idIdx = initialCollisions.second.size() - 1;
-						 idIdx < initialCollisions.second.size(); idIdx--) {
-						if (!_doCollide(entityA->getCollider(),
-										entityA->getPosition(),
-										getEntityById(
-											initialCollisions.second[idIdx]))) {
-							initialCollisions.second.erase(
-								initialCollisions.second.begin() + idIdx);
-						}
-					}
-					if (initialCollisions.second.empty())
-						idxToDelete.push_back(initialCollisions.first);
-				}
-				for (auto idx : idxToDelete) {
-					_initialCollisionMap.erase(idx);
-				}
+		_profiler.stop(PhaseInput);
+
+		_deltaTime = tickDuration;
+		while (accumulator >= tickDuration) {
+			accumulator -= tickDuration;
+			_isRunningTick = true;
+			isRunning = _runTick(newSceneIdx);
+			_isRunningTick = false;
+			if (!isRunning) break;
+			_tickCount++;
+			if (_maxTicks != 0 && _tickCount >= _maxTicks) {
+				isRunning = false;
+				break;
 			}
 		}
+		if (!isRunning) break;
+
+		// Render in between the last two ticks
+		_interpolationAlpha = _fastForward ? 1.0f : accumulator / tickDuration;
+		_deltaTime = _frameDeltaTime;
 		_gameRenderer->refreshWindow(_allEntities, _camera, _light, _skybox);
 
 		if (_game->needResolutionChange) _setNewResolution();
+		_profiler.endFrame();
+
+		// Nothing to draw, wait for the next tick instead of spinning
+		if (_headless && !_fastForward)
+			std::this_thread::sleep_for(
+				std::chrono::duration<double>(tickDuration - accumulator));
 	}
 	if (newSceneIdx != -1) {
 		_sceneIdx = newSceneIdx;
@@ -268,15 +315,133 @@ void GameEngine::run(void) {
 	}
 }
 
-Entity *GameEngine::getEntityById(size_t id) {
-	Entity *foundElem = nullptr;
-	for (auto entity : _allEntities) {
-		if (entity->getId() == id) {
-			foundElem = entity;
-			break;
+bool GameEngine::_runTick(int &newSceneIdx) {
+	_applyInputScript();
+
+	// Profiler shortcuts
+	if (isKeyJustPressed(KEY_F3)) _profiler.toggleOverlay();
+	if (isKeyJustPressed(KEY_F4)) {
+		std::string csvPath =
+			"profiler_" + std::to_string(std::time(nullptr)) + ".csv";
+		if (_profiler.dumpCSV(csvPath))
+			std::cout << "Profiler samples saved to " << csvPath << std::endl;
+	}
+
+	// Interpolation will start from current state
+	_profiler.start(PhaseCamera);
+	_camera->savePreviousPosition();
+	for (auto entity : _allEntities) entity->savePreviousPosition();
+
+	// Update game camera
+	_camera->update();
+	_profiler.stop(PhaseCamera);
+	newSceneIdx = _camera->getNewSceneIdx();
+	if (newSceneIdx != -1) return false;
+	newSceneIdx = _game->getSceneIndexByName(_camera->getNewSceneName());
+	if (newSceneIdx != -1) return false;
+
+	if (!_camera->isGameRunning()) return false;
+
+	// Freeze everything else if camera tells so
+	if (!_camera->isPause()) {
+		_profiler.start(PhaseEntities);
+		if (_light) _light->update();
+		// Update game entities states
+		for (auto entity : _allEntities) {
+			entity->update();
+		}
+		_profiler.stop(PhaseEntities);
+
+		// Merge new game entities
+		_profiler.start(PhaseMerge);
+		if (!_newEntities.empty()) {
+			// Register new entities first so they also see each other
+			for (auto newEntity : _newEntities)
+				_registerCollider(newEntity);
+			for (auto newEntity : _newEntities) {
+				if (newEntity->getCollider() == nullptr ||
+					newEntity->getCollider()->isTrigger)
+					continue;
+				// Triggers are not needed here, they just share the buffer
+				_mergeCollisions.clear();
+				_mergeTriggers.clear();
+				_getPossibleCollisions(newEntity, _mergeCollisions,
+									   _mergeTriggers, true);
+				// Possible collision that have been detected are sure to
+				// collide since newEntities do not have any targetMovement
+				// yet
+				for (auto collidedEntity : _mergeCollisions) {
+					if (_doCollide(newEntity->getCollider(),
+								   newEntity->getPosition(), collidedEntity))
+						_initialCollisions.insert(newEntity->getId(),
+												  collidedEntity->getId());
+				}
+			}
+			_allEntities.insert(_allEntities.end(), _newEntities.begin(),
+								_newEntities.end());
+			_newEntities.clear();
 		}
+		_profiler.stop(PhaseMerge);
+
+		// Do movement (with collisions + trigger detection)
+		_profiler.start(PhaseMove);
+		_moveEntities();
+		_profiler.stop(PhaseMove);
+
+		// Delete game entities if needed, in a single pass keeping the order
+		_profiler.start(PhaseDestroy);
+		size_t aliveCount = 0;
+		for (size_t idx = 0; idx < _allEntities.size(); idx++) {
+			Entity *entity = _allEntities[idx];
+			if (!entity->needsToBeDestroyed()) {
+				_allEntities[aliveCount++] = entity;
+				continue;
+			}
+			_initialCollisions.eraseAll(entity->getId());
+			_unregisterCollider(entity);
+			_entityRegistry.remove(entity);
+			delete entity;
+		}
+		_allEntities.resize(aliveCount);
+		_profiler.stop(PhaseDestroy);
+
+		// Forget initial collisions that are now resolved
+		_profiler.start(PhaseInitialCollisions);
+		Entity *entityA;
+		Entity *entityB;
+		for (size_t idx = _initialCollisions.size(); idx-- > 0;) {
+			CollisionPair const &pair = _initialCollisions[idx];
+			entityA = getEntityById(pair.first);
+			entityB = getEntityById(pair.second);
+			// Just to be sure
+			if (entityA == nullptr || entityB == nullptr ||
+				!_doCollide(entityA->getCollider(), entityA->getPosition(),
+							entityB))
+				_initialCollisions.erase(pair.first, pair.second);
+		}
+		_profiler.stop(PhaseInitialCollisions);
 	}
-	return foundElem;
+
+	// This tick consumed the presses, later ticks won't see them again
+	for (auto &key : _keyboardMap) key.second.tickPressed = false;
+	return true;
+}
+
+void GameEngine::_rollKeysOver(void) {
+	// Once per frame, for what reads keys outside of ticks (GUI, loading)
+	for (auto &key : _keyboardMap) key.second.prevFrame = key.second.currFrame;
+}
+
+Entity *GameEngine::getEntityById(size_t id) {
+	return _entityRegistry.getById(id);
+}
+
+Entity *GameEngine::getEntity(EntityHandle const &handle) const {
+	return _entityRegistry.get(handle);
+}
+
+EntityHandle GameEngine::getEntityHandle(Entity *entity) const {
+	return _entityRegistry.getHandle(entity);
 }
 
 // Entity *GameEngine::getFirstEntityWithName(std::string entityName) {
@@ -290,6 +455,15 @@ Entity *GameEngine::getEntityById(size_t id) {
 // 	return foundElem;
 // }
 
+void GameEngine::_applyInputScript(void) {
+	while (_inputScriptIdx < _inputScript.size() &&
+		   _inputScript[_inputScriptIdx].tick <= _tickCount) {
+		buttonStateChanged(_inputScript[_inputScriptIdx].keyID,
+						   _inputScript[_inputScriptIdx].isPressed);
+		_inputScriptIdx++;
+	}
+}
+
 void GameEngine::_setSceneVariables(void) {
 	_camera = _game->getCamera();
 	if (_camera == nullptr)
@@ -297,12 +471,14 @@ void GameEngine::_setSceneVariables(void) {
 			"\033[0;31m:Error:\033[0m No camera were created in the loaded "
 			"scene.");
 	_camera->initEntity(this);
-	_camera->configGUI(_gameRenderer->getGUI());
+	if (!_headless) _camera->configGUI(_gameRenderer->getGUI());
 
 	_skybox = _game->getSkybox();
 	if (_skybox != nullptr) {
-		_skybox->_initBuffer();
-		_skybox->_initCubeMap();
+		if (!_headless) {
+			_skybox->_initBuffer();
+			_skybox->_initCubeMap();
+		}
 		_skybox->initEntity(this);
 	}
 
@@ -319,6 +495,8 @@ void GameEngine::_setSceneVariables(void) {
 	for (auto entity : _game->getEntities()) {
 		_allEntities.push_back(entity);
 		_allEntities.back()->initEntity(this);
+		_entityRegistry.add(entity);
+		_registerCollider(entity);
 	}
 }
 
@@ -329,12 +507,14 @@ void GameEngine::_setLoadingSceneVariables(void) {
 			"\033[0;31m:Error:\033[0m No camera were created in the loaded "
 			"scene.");
 	_loadingCamera->initEntity(this);
-	_loadingCamera->configGUI(_gameRenderer->getGUI());
+	if (!_headless) _loadingCamera->configGUI(_gameRenderer->getGUI());
 
 	_loadingSkybox = _game->getLoadingSkybox();
 	if (_loadingSkybox != nullptr) {
-		_loadingSkybox->_initBuffer();
-		_loadingSkybox->_initCubeMap();
+		if (!_headless) {
+			_loadingSkybox->_initBuffer();
+			_loadingSkybox->_initCubeMap();
+		}
 		_loadingSkybox->initEntity(this);
 	}
 
@@ -389,7 +569,10 @@ void GameEngine::_unloadScene(void) {
 		delete _skybox;
 		_skybox = nullptr;
 	}
-	_initialCollisionMap.clear();
+	_initialCollisions.clear();
+	_entityRegistry.clear();
+	_spatialGrid.clear();
+	_tileLayer.clear();
 }
 
 void GameEngine::_loadScene(size_t newSceneIdx, std::atomic_int *_sceneState,
@@ -399,31 +582,25 @@ void GameEngine::_loadScene(size_t newSceneIdx, std::atomic_int *_sceneState,
 
 void GameEngine::_moveEntities(void) {
 	const Collider *collider;
-	bool isShortcut = false;
-	std::vector<Entity *> collidedEntitiesBck;
 	std::vector<Entity *> collidedEntities;
 	std::vector<Entity *> collidedTriggers;
-	Entity *shortcutEntity;
+	std::vector<Entity *> blockingTiles;
+	std::vector<Entity *> hitBodies;
 	glm::vec3 futureMovement = glm::vec3();
-	glm::vec3 shortcutMovement = glm::vec3();
-	LineInfo lineA;
-	LineInfo lineB;
-	size_t idx = 0;
-
-	size_t idxOfCollision = 0;
-	bool firstLoop = true;
-	bool hasCollided = true;
+	glm::vec3 startPosition;
+	glm::vec3 bodiesMovement;
+	glm::vec3 normal;
+	float time;
+
 	for (auto entity : _allEntities) {
 		if (!entity->needsToBeDestroyed()) {
 			collider = entity->getCollider();
-			collidedEntitiesBck.clear();
 			collidedEntities.clear();
 			collidedTriggers.clear();
-			isShortcut = false;
-			firstLoop = true;
-			hasCollided = false;
-			shortcutEntity = nullptr;
+			blockingTiles.clear();
+			hitBodies.clear();
 			futureMovement = entity->getTargetMovement();
+			futureMovement.y = 0.0f;
 
 			if (futureMovement.x == 0.0f && futureMovement.z == 0.0f &&
 				(collider == nullptr || !collider->isTrigger))
@@ -431,429 +608,499 @@ void GameEngine::_moveEntities(void) {
 
 			// Skip checks if entity doesnt have a collider
 			if (collider != nullptr) {
-				// Init vars before first loop
+				// Triggers still need static tiles to report them
 				_getPossibleCollisions(entity, collidedEntities,
-									   collidedTriggers, _allEntities);
-				collidedEntitiesBck = collidedEntities;
-				futureMovement.x = entity->getTargetMovement().x;
-				futureMovement.z = entity->getTargetMovement().z;
-
-				// Apply shorter and shorter movement until no collision is
-				// detected
-				while (collidedEntities.size() != 0) {
-					idxOfCollision = _checkCollision(entity, futureMovement,
-													 collidedEntities);
-					// Update entities to check collisions with
-					if (idxOfCollision != 0) {
-						collidedEntities.erase(
-							collidedEntities.begin(),
-							collidedEntities.begin() + idxOfCollision);
-					}
-
-					// If some collisions are detected, try with a different
-					// movement
-					if (collidedEntities.size() != 0) {
-						if (firstLoop) {
-							// Special test that need to be done only on
-							// first loop
-							if (_tryShortcut(
-									entity, futureMovement, shortcutMovement,
-									collidedEntities[0], collidedEntitiesBck)) {
-								shortcutEntity = collidedEntities[0];
-								isShortcut = true;
-								futureMovement = shortcutMovement;
-								break;
-							}
-							firstLoop = false;
-						}
-
-						// Loop again only for big movements
-						if (abs(futureMovement.x) <= 0.5f &&
-							abs(futureMovement.z) <= 0.5f) {
-							break;
-						}
-						// Slightly decrease futureMovement to see if
-						// smaller movement can be performed
-						futureMovement.x /= 2.0f;
-						futureMovement.z /= 2.0f;
+									   collidedTriggers, collider->isTrigger);
+				startPosition = entity->getPosition();
+
+				// Static tiles only shorten movement, remaining dynamic
+				// bodies are swept below
+				if (!collider->isTrigger)
+					_moveAgainstTiles(entity, futureMovement, blockingTiles,
+									  true);
+
+				// Stop at the first contact with a body and slide along it
+				bodiesMovement = futureMovement;
+				_sweepBodies(entity, futureMovement, collidedEntities,
+							 hitBodies);
+				// Sliding may lead back into a tile, but never around it
+				if (!collider->isTrigger && futureMovement != bodiesMovement)
+					_moveAgainstTiles(entity, futureMovement, blockingTiles,
+									  false);
+
+				// Zero movement triggers (explosions) report what they cover
+				if (collider->isTrigger) {
+					for (auto other : collidedEntities) {
+						if (std::find(hitBodies.begin(), hitBodies.end(),
+									  other) == hitBodies.end() &&
+							_doCollide(collider,
+									   startPosition + futureMovement, other))
+							hitBodies.push_back(other);
 					}
 				}
 
-				// Collide with colliders (do not consider shortcut move yet)
-				while (!collidedEntitiesBck.empty() &&
-					   !entity->needsToBeDestroyed()) {
-					idx = _checkCollision(entity, futureMovement,
-										  collidedEntitiesBck);
-					if (idx != collidedEntitiesBck.size()) {
-						hasCollided = true;
-						// Other entity will always be a collider
-						if (!collidedEntitiesBck[idx]->needsToBeDestroyed())
-							collidedEntitiesBck[idx]->onCollisionEnter(entity);
-						// Check if we are a trigger or a collider
-						if (!entity->needsToBeDestroyed()) {
-							if (collider->isTrigger)
-								entity->onTriggerEnter(
-									collidedEntitiesBck[idx]);
-							else
-								entity->onCollisionEnter(
-									collidedEntitiesBck[idx]);
-						}
-						// Clear entities
-						collidedEntitiesBck.erase(
-							collidedEntitiesBck.begin(),
-							collidedEntitiesBck.begin() + idx + 1);
-					} else {
-						collidedEntitiesBck.clear();
-					}
-				}
-				// Apply shortcut and clear collisions
-				if (isShortcut) {
-					hasCollided = false;
-					futureMovement = shortcutMovement;
-					collidedEntities.clear();
-
-					// Trigger on shortcutted entity
-
+				// Collide with bodies that blocked the movement
+				for (auto other : hitBodies) {
+					if (entity->needsToBeDestroyed()) break;
 					// Other entity will always be a collider
-					if (!shortcutEntity->needsToBeDestroyed())
-						shortcutEntity->onCollisionEnter(entity);
+					if (!other->needsToBeDestroyed())
+						other->onCollisionEnter(entity);
 					// Check if we are a trigger or a collider
 					if (!entity->needsToBeDestroyed()) {
 						if (collider->isTrigger)
-							entity->onTriggerEnter(shortcutEntity);
+							entity->onTriggerEnter(other);
 						else
-							entity->onCollisionEnter(shortcutEntity);
+							entity->onCollisionEnter(other);
 					}
 				}
-				// Trigger all triggers
-				while (!collidedTriggers.empty() &&
-					   !entity->needsToBeDestroyed()) {
-					idx = _checkCollision(entity, futureMovement,
-										  collidedTriggers);
-					if (idx != collidedTriggers.size()) {
-						// Other entity will always be a trigger
-						collidedTriggers[idx]->onTriggerEnter(entity);
-						// Check if we are a trigger or a collider
+				// Collide with static tiles that blocked the movement
+				for (auto tile : blockingTiles) {
+					if (entity->needsToBeDestroyed()) break;
+					if (!tile->needsToBeDestroyed())
+						tile->onCollisionEnter(entity);
+					if (!entity->needsToBeDestroyed())
+						entity->onCollisionEnter(tile);
+				}
+				// Trigger all triggers crossed or touched by the movement
+				for (auto trigger : collidedTriggers) {
+					if (entity->needsToBeDestroyed()) break;
+					if (trigger->needsToBeDestroyed()) continue;
+					if (!_doCollide(collider, startPosition, trigger) &&
+						!_doCollide(collider, startPosition + futureMovement,
+									trigger) &&
+						!_sweepShape(entity, startPosition, futureMovement,
+									 trigger, 0.0f, time, normal))
+						continue;
+					// Other entity will always be a trigger
+					trigger->onTriggerEnter(entity);
+					// Check if we are a trigger or a collider
+					if (!entity->needsToBeDestroyed()) {
 						if (collider->isTrigger)
-							entity->onTriggerEnter(collidedTriggers[idx]);
+							entity->onTriggerEnter(trigger);
 						else
-							entity->onCollisionEnter(collidedTriggers[idx]);
-						// Clear entities
-						collidedTriggers.erase(
-							collidedTriggers.begin(),
-							collidedTriggers.begin() + idx + 1);
-					} else
-						collidedTriggers.clear();
+							entity->onCollisionEnter(trigger);
+					}
 				}
 			}
 
 			if ((futureMovement.x != 0 || futureMovement.z != 0) &&
-				!hasCollided && !entity->needsToBeDestroyed()) {
+				!entity->needsToBeDestroyed()) {
 				entity->translate(futureMovement);
 			}
 		}
 	}
 }
+
+void GameEngine::_registerCollider(Entity *entity) {
+	if (entity->getCollider() == nullptr) return;
+	if (!_tileLayer.insert(entity)) _spatialGrid.insert(entity);
+}
+
+void GameEngine::_unregisterCollider(Entity *entity) {
+	_tileLayer.remove(entity);
+	_spatialGrid.remove(entity);
+}
+
 void GameEngine::_getPossibleCollisions(
 	Entity *entity, std::vector<Entity *> &possibleCollisions,
-	std::vector<Entity *> &possibleTriggers,
-	std::vector<Entity *> &entitiesToTest) {
+	std::vector<Entity *> &possibleTriggers, bool withStaticTiles) {
 	const Collider *collider = entity->getCollider();
 
 	if (collider) {
-		// Skip collision with object that cannot collide with
-		bool canCollide = false;
 		RectanglePoints rectanglePoints(entity, entity->getTargetMovement());
-		for (size_t i = 0; i < entitiesToTest.size(); i++) {
-			canCollide = false;
-			// Skip self
-			if (entity->getId() == entitiesToTest[i]->getId()) continue;
-
-			// Skip if dead entity
-			if (entity->needsToBeDestroyed()) continue;
-
-			// Skip if it's an initialCollision
-			if (_initialCollisionMap.find(entitiesToTest[i]->getId()) !=
-					_initialCollisionMap.end() &&
-				std::find(
-					_initialCollisionMap[entitiesToTest[i]->getId()].begin(),
-					_initialCollisionMap[entitiesToTest[i]->getId()].end(),
-					entity->getId()) !=
-					_initialCollisionMap[entitiesToTest[i]->getId()].end())
-				continue;
-
-			// Compare Layers
-			if (entitiesToTest[i]->getCollider() != nullptr &&
-				_collisionTable[collider->layerTag]
-							   [entitiesToTest[i]->getCollider()->layerTag]) {
-				// Fast check to know if is remotely possible that a
-				// collision may occurr
-				RectanglePoints otherPoints(entitiesToTest[i]);
-				if (rectanglePoints.top <= otherPoints.bot &&
-					otherPoints.top <= rectanglePoints.bot) {
-					if (rectanglePoints.left <= otherPoints.right &&
-						otherPoints.left <= rectanglePoints.right)
-						canCollide = true;
-				}
-			}
-
-			if (canCollide) {
-				(entitiesToTest[i]->getCollider()->isTrigger)
-					? possibleTriggers.push_back(entitiesToTest[i])
-					: possibleCollisions.push_back(entitiesToTest[i]);
+		// Bodies on layers this one ignores are dropped by the queries
+		LayerMask layers = _collisionMasks[collider->layerTag];
+		// Other rectangles are made a little bigger too, widen query as much
+		_broadphaseCandidates.clear();
+		_spatialGrid.query(
+			rectanglePoints.left - EPSILON, rectanglePoints.top - EPSILON,
+			rectanglePoints.right + EPSILON, rectanglePoints.bot + EPSILON,
+			_broadphaseCandidates, layers);
+		if (withStaticTiles)
+			_tileLayer.query(
+				rectanglePoints.left - EPSILON, rectanglePoints.top - EPSILON,
+				rectanglePoints.right + EPSILON, rectanglePoints.bot + EPSILON,
+				_broadphaseCandidates, layers);
+		// Cells do not keep insertion order, sort to stay deterministic
+		std::sort(_broadphaseCandidates.begin(), _broadphaseCandidates.end(),
+				  [](Entity *a, Entity *b) { return a->getId() < b->getId(); });
+		for (auto entityToTest : _broadphaseCandidates) {
+			if (_isPossibleCollision(entity, rectanglePoints, entityToTest)) {
+				(entityToTest->getCollider()->isTrigger)
+					? possibleTriggers.push_back(entityToTest)
+					: possibleCollisions.push_back(entityToTest);
 			}
 		}
 	}
 }
 
-size_t GameEngine::_checkCollision(Entity *entity, glm::vec3 &futureMovement,
-								   std::vector<Entity *> &collidedEntities) {
-	if (collidedEntities.size() == 0) return 0;
-	// Init
-	glm::vec3 futurePos = glm::vec3();
-	LineInfo lineA;
-	LineInfo lineB;
-
-	// 1) Find lines that inglobe movement
-	_getMovementLines(entity, futureMovement, &lineA, &lineB);
-	// If lines are vertical, create Rectangle Collider only
-	// once
-	int layer1 = entity->getCollider()->layerTag;
-	Collider moveCollider(Collider::Rectangle, layer1, 0.0f, 0.0f);
-	glm::vec3 centerPos = glm::vec3();
-	if (lineA.isVertical) {
-		moveCollider.width = abs(lineA.startX - lineB.startX) / 2.0f;
-		moveCollider.height = abs(lineA.startZ - lineA.endZ) / 2.0f;
-		centerPos.x = (lineA.startX + lineB.startX) / 2;
-		centerPos.z = (lineA.startZ + lineA.endZ) / 2;
+bool GameEngine::_canCollide(Entity *entity, Entity *entityToTest) {
+	// Skip self
+	if (entity->getId() == entityToTest->getId()) return false;
+
+	// Skip if dead entity
+	if (entity->needsToBeDestroyed()) return false;
+
+	// Skip if it's an initialCollision
+	if (_initialCollisions.contains(entity->getId(), entityToTest->getId()))
+		return false;
+
+	// Compare Layers
+	return entityToTest->getCollider() != nullptr &&
+		   (_collisionMasks[entity->getCollider()->layerTag] &
+			layerBit(entityToTest->getCollider()->layerTag));
+}
+
+bool GameEngine::_isPossibleCollision(Entity *entity,
+									  RectanglePoints const &rectanglePoints,
+									  Entity *entityToTest) {
+	if (!_canCollide(entity, entityToTest)) return false;
+
+	// Fast check to know if is remotely possible that a collision may occurr
+	RectanglePoints otherPoints(entityToTest);
+	return rectanglePoints.top <= otherPoints.bot &&
+		   otherPoints.top <= rectanglePoints.bot &&
+		   rectanglePoints.left <= otherPoints.right &&
+		   otherPoints.left <= rectanglePoints.right;
+}
+
+void GameEngine::_moveAgainstTiles(Entity *entity, glm::vec3 &futureMovement,
+								   std::vector<Entity *> &blockingTiles,
+								   bool canSlide) {
+	std::vector<Entity *> xBlockingTiles;
+	std::vector<Entity *> zBlockingTiles;
+	glm::vec3 position = entity->getPosition();
+	float absX = abs(futureMovement.x);
+	float absZ = abs(futureMovement.z);
+
+	// Resolve each axis on its own, tiles make this a few lookups
+	if (futureMovement.x != 0.0f) {
+		futureMovement.x = _sweepTiles(entity, position, true, futureMovement.x,
+									   xBlockingTiles);
+		position.x += futureMovement.x;
+	}
+	if (futureMovement.z != 0.0f) {
+		futureMovement.z = _sweepTiles(entity, position, false,
+									   futureMovement.z, zBlockingTiles);
+		position.z += futureMovement.z;
 	}
 
-	// Simulate movement
-	futurePos.x = entity->getPosition().x + futureMovement.x;
-	futurePos.z = entity->getPosition().z + futureMovement.z;
-
-	size_t idxToTest = 0;
-	for (auto entityToTest : collidedEntities) {
-		// 2) Check if final position collides with smth
-		// 3) Check if any other obj collides with lineA/lineB
-		if (!entityToTest->needsToBeDestroyed() &&
-			(_doCollide(entity->getCollider(), futurePos, entityToTest) ||
-			 (lineA.isVertical &&
-			  _doCollide(&moveCollider, centerPos, entityToTest)) ||
-			 (!lineA.isVertical &&
-			  _hasCollisionCourse(lineA, lineB, layer1, entityToTest)))) {
-			break;
-		}
-		idxToTest++;
+	// Circles "circle around" tile corners when mostly outside of them,
+	// only along the least important targetMovement
+	if (canSlide && entity->getCollider()->shape == Collider::Circle) {
+		if (!xBlockingTiles.empty() && absX >= absZ &&
+			futureMovement.z == 0.0f)
+			futureMovement.z = _slideAroundTiles(
+				entity, position, false, absX, xBlockingTiles, zBlockingTiles);
+		else if (!zBlockingTiles.empty() && absZ >= absX &&
+				 futureMovement.x == 0.0f)
+			futureMovement.x = _slideAroundTiles(
+				entity, position, true, absZ, zBlockingTiles, xBlockingTiles);
 	}
 
-	return idxToTest;
+	for (auto tile : xBlockingTiles) {
+		if (std::find(blockingTiles.begin(), blockingTiles.end(), tile) ==
+			blockingTiles.end())
+			blockingTiles.push_back(tile);
+	}
+	for (auto tile : zBlockingTiles) {
+		if (std::find(blockingTiles.begin(), blockingTiles.end(), tile) ==
+			blockingTiles.end())
+			blockingTiles.push_back(tile);
+	}
 }
 
-void GameEngine::_getMovementLines(Entity *entity, glm::vec3 &targetMovement,
-								   LineInfo *lineA, LineInfo *lineB) {
-	// Find points that will determine Lines
-	lineA->startX = entity->getPosition().x;
-	lineA->startZ = entity->getPosition().z;
-	lineB->startX = entity->getPosition().x;
-	lineB->startZ = entity->getPosition().z;
-	// Avoid division by 0 if movement is only along 'z' axis
-	if (targetMovement.x == 0.0f) {
-		lineA->startX += entity->getCollider()->width;
-		lineB->startX -= entity->getCollider()->width;
-		lineA->isVertical = true;
-		lineA->q = lineA->startX;
-		lineB->isVertical = true;
-		lineB->q = lineB->startX;
-	} else {
-		// Find 'm' of direction from center to target center
-		float m =
-			targetMovement.z / targetMovement.x;  // TargetMovement is already
-												  // a delta of coords
-		lineA->m = m;
-		lineB->m = m;
-		lineA->isVertical = false;
-		lineB->isVertical = false;
-
-		// Find points based on shape
-		if (entity->getCollider()->shape == Collider::Rectangle) {
-			// Rectangle
-			if ((targetMovement.x > 0.0f && targetMovement.z > 0.0f) ||
-				(targetMovement.x < 0.0f && targetMovement.z < 0.0f)) {
-				// We are going Down-Right or Up-Left, take TopRight(A) and
-				// BottomLeft(B) corners
-				lineA->startX += entity->getCollider()->width;
-				lineA->startZ -= entity->getCollider()->height;
-				lineB->startX -= entity->getCollider()->width;
-				lineB->startZ += entity->getCollider()->height;
-			} else {
-				// We are going Down-Left or Up-Right, take TopLeft(A) and
-				// BottomRight(B) corners
-				lineA->startX -= entity->getCollider()->width;
-				lineA->startZ -= entity->getCollider()->height;
-				lineB->startX += entity->getCollider()->width;
-				lineB->startZ += entity->getCollider()->height;
-			}
-		} else {
-			// Circle
-			// mPrime = - 1 / m
-			float mPerpendicular = -(1.0f / m);
-			// q of line that will intercept startA and startB
-			float q = entity->getPosition().z -
-					  mPerpendicular * entity->getPosition().x;
-
-			float xOffset = mPerpendicular * entity->getCollider()->width;
-			lineA->startX += xOffset;
-			lineB->startX -= xOffset;
-			// since we have 'mPerpendicular', 'q' and 'x' we can easily get
-			// 'z'
-			lineA->startZ = mPerpendicular * lineA->startX + q;
-			lineB->startZ = mPerpendicular * lineB->startX + q;
+float GameEngine::_sweepTiles(Entity *entity, glm::vec3 const &position,
+							  bool alongX, float movement,
+							  std::vector<Entity *> &blockingTiles) {
+	const Collider *collider = entity->getCollider();
+	float sign = (movement > 0.0f) ? 1.0f : -1.0f;
+	float center = alongX ? position.x : position.z;
+	float side = alongX ? position.z : position.x;
+	float halfSize = alongX ? collider->width : collider->height;
+	float sideHalfSize = alongX ? collider->height : collider->width;
+	float front = center + sign * halfSize;
+
+	// Cells swept by the front edge, and the ones covered on the side
+	float sweepStart = front - sign * EPSILON;
+	float sweepEnd = front + movement;
+	int minRow = _tileLayer.toTile(std::min(sweepStart, sweepEnd) - 0.5f);
+	int maxRow = _tileLayer.toTile(std::max(sweepStart, sweepEnd) + 0.5f);
+	int minCol = _tileLayer.toTile(side - sideHalfSize - 0.5f);
+	int maxCol = _tileLayer.toTile(side + sideHalfSize + 0.5f);
+
+	float allowed = abs(movement);
+	size_t firstBlocking = blockingTiles.size();
+	Entity *tile;
+	const Collider *tileCollider;
+	for (int row = minRow; row <= maxRow; row++) {
+		for (int col = minCol; col <= maxCol; col++) {
+			tile = alongX ? _tileLayer.getTile(row, col)
+						  : _tileLayer.getTile(col, row);
+			if (tile == nullptr || tile->needsToBeDestroyed() ||
+				!_canCollide(entity, tile))
+				continue;
+			tileCollider = tile->getCollider();
+			float tileCenter = alongX ? tile->getPosition().x
+									  : tile->getPosition().z;
+			float tileSide = alongX ? tile->getPosition().z
+									: tile->getPosition().x;
+			float tileHalfSize =
+				alongX ? tileCollider->width : tileCollider->height;
+			float tileSideHalfSize =
+				alongX ? tileCollider->height : tileCollider->width;
+
+			// Only touching on the side, we can slide along it
+			if (side + sideHalfSize <= tileSide - tileSideHalfSize + EPSILON ||
+				side - sideHalfSize >= tileSide + tileSideHalfSize - EPSILON)
+				continue;
+			// Distance from our front edge to the facing edge of the tile
+			float distance = (tileCenter - sign * tileHalfSize - front) * sign;
+			if (distance < -EPSILON) continue;  // Already inside, let it go
+			float freeDistance = std::max(0.0f, distance - CONTACT_GAP);
+			if (freeDistance >= abs(movement)) continue;
+
+			// Keep every tile of the closest row, they block us together
+			if (freeDistance > allowed + EPSILON) continue;
+			if (freeDistance < allowed - EPSILON)
+				blockingTiles.resize(firstBlocking);
+			allowed = std::min(allowed, freeDistance);
+			blockingTiles.push_back(tile);
 		}
+	}
+	return sign * allowed;
+}
 
-		// With m and boh starting points, we can easily get 'q' for lineA
-		// and lineB
-		lineA->q = lineA->startZ - m * lineA->startX;
-		lineB->q = lineB->startZ - m * lineB->startX;
+float GameEngine::_slideAroundTiles(Entity *entity, glm::vec3 const &position,
+									bool alongX, float maxSlide,
+									std::vector<Entity *> const &tilesToAvoid,
+									std::vector<Entity *> &blockingTiles) {
+	float center = alongX ? position.x : position.z;
+	float radius = entity->getCollider()->width;
+	float tilesStart = center;
+	float tilesEnd = center;
+	bool firstTile = true;
+
+	// Blocking tiles are seen as one obstacle
+	for (auto tile : tilesToAvoid) {
+		float tileCenter = alongX ? tile->getPosition().x : tile->getPosition().z;
+		float tileHalfSize =
+			alongX ? tile->getCollider()->width : tile->getCollider()->height;
+		if (firstTile || tileCenter - tileHalfSize < tilesStart)
+			tilesStart = tileCenter - tileHalfSize;
+		if (firstTile || tileCenter + tileHalfSize > tilesEnd)
+			tilesEnd = tileCenter + tileHalfSize;
+		firstTile = false;
 	}
 
-	// Add end point infos
-	lineA->endX = lineA->startX + targetMovement.x;
-	lineA->endZ = lineA->startZ + targetMovement.z;
-	lineB->endX = lineB->startX + targetMovement.x;
-	lineB->endZ = lineB->startZ + targetMovement.z;
+	// Only slide if more than half is outside of the obstacle
+	float slide;
+	if (center > tilesEnd)
+		slide = tilesEnd - (center - radius) + CONTACT_GAP;
+	else if (center < tilesStart)
+		slide = tilesStart - (center + radius) - CONTACT_GAP;
+	else
+		return 0.0f;
+	// Do not slide faster than half the blocked movement
+	if (abs(slide) > maxSlide / 2.0f)
+		slide = (slide > 0.0f) ? maxSlide / 2.0f : -maxSlide / 2.0f;
+	return _sweepTiles(entity, position, alongX, slide, blockingTiles);
 }
 
-bool GameEngine::_hasCollisionCourse(LineInfo &lineA, LineInfo &lineB,
-									 int layerTag, Entity *entityB) {
-	// Check to avoid errors
-	if (lineA.isVertical || lineB.isVertical) {
-		// Easy case, we can use _doCollide() since we have a "standard"
-		// rectangle
-		Collider testCollider(Collider::Rectangle, layerTag,
-							  abs(lineA.startX - lineB.startX) / 2,
-							  abs(lineA.startZ - lineA.endZ) / 2);
-		glm::vec3 centerPos = glm::vec3();
-		centerPos.x = (lineA.startX + lineB.startX) / 2;
-		centerPos.z = (lineA.startZ + lineA.endZ) / 2;
-		// return false;
-		return _doCollide(&testCollider, centerPos, entityB);
+void GameEngine::_getPossibleCollisionsLinear(
+	Entity *entity, std::vector<Entity *> &possibleCollisions,
+	std::vector<Entity *> &possibleTriggers, bool withStaticTiles) {
+	RectanglePoints rectanglePoints(entity, entity->getTargetMovement());
+	for (auto entityToTest : _allEntities) {
+		if (!withStaticTiles && _tileLayer.contains(entityToTest)) continue;
+		if (_isPossibleCollision(entity, rectanglePoints, entityToTest)) {
+			(entityToTest->getCollider()->isTrigger)
+				? possibleTriggers.push_back(entityToTest)
+				: possibleCollisions.push_back(entityToTest);
+		}
 	}
+}
 
-	// Classic case
-	const Collider *colliderB = entityB->getCollider();
-	if (colliderB->shape == Collider::Rectangle) {
-		// Rectangle
-		float leftX = entityB->getPosition().x - colliderB->width;
-		float rightX = entityB->getPosition().x + colliderB->width;
-		float upZ = entityB->getPosition().z - colliderB->height;
-		float downZ = entityB->getPosition().z + colliderB->height;
-		LineInfo tmpLine(leftX, upZ, rightX, upZ);
-		if (_isLineLineCollision(lineA, tmpLine) ||
-			_isLineLineCollision(lineB, tmpLine)) {
-			return true;
-		}
-		tmpLine = LineInfo(leftX, downZ, rightX, downZ);
-		if (_isLineLineCollision(lineA, tmpLine) ||
-			_isLineLineCollision(lineB, tmpLine)) {
-			return true;
-		}
-		tmpLine = LineInfo(leftX, upZ, leftX, downZ);
-		if (_isLineLineCollision(lineA, tmpLine) ||
-			_isLineLineCollision(lineB, tmpLine)) {
-			return true;
-		}
-		tmpLine = LineInfo(rightX, upZ, rightX, downZ);
-		if (_isLineLineCollision(lineA, tmpLine) ||
-			_isLineLineCollision(lineB, tmpLine)) {
-			return true;
-		}
-	} else {
-		// Circle
-		// To be true it must be one of the following
-		// 1) Circle intersects with (at least one) line and point of
-		// intersection is between start end end
-		float xSquareCoeff = 1.0f;
-		float xCoeff = -(2.0f * entityB->getPosition().x);
-		float zSquareCoeff = 1.0f;
-		float zCoeff = -(2.0f * entityB->getPosition().z);
-		float cCoeff = colliderB->width + pow(entityB->getPosition().x, 2) +
-					   pow(entityB->getPosition().z, 2);
-		if (_isLineCircleCollision(lineA, xSquareCoeff, xCoeff, zSquareCoeff,
-								   zCoeff, cCoeff)) {
-			return true;
+void GameEngine::_sweepBodies(Entity *entity, glm::vec3 &futureMovement,
+							  std::vector<Entity *> const &bodies,
+							  std::vector<Entity *> &hitBodies) {
+	glm::vec3 position = entity->getPosition();
+	glm::vec3 remaining = futureMovement;
+	glm::vec3 normal;
+	glm::vec3 firstNormal;
+	Entity *firstHit;
+	float time;
+	float firstTime;
+
+	futureMovement = glm::vec3(0.0f);
+	for (size_t iteration = 0; iteration < SWEEP_ITERATIONS; iteration++) {
+		if (remaining.x == 0.0f && remaining.z == 0.0f) break;
+		firstHit = nullptr;
+		firstTime = 1.0f;
+		for (auto body : bodies) {
+			if (body->needsToBeDestroyed()) continue;
+			if (_sweepShape(entity, position + futureMovement, remaining, body,
+							CONTACT_GAP, time, normal) &&
+				(firstHit == nullptr || time < firstTime)) {
+				firstHit = body;
+				firstTime = time;
+				firstNormal = normal;
+			}
 		}
-		if (_isLineCircleCollision(lineB, xSquareCoeff, xCoeff, zSquareCoeff,
-								   zCoeff, cCoeff)) {
-			return true;
+		if (firstHit == nullptr) {
+			futureMovement += remaining;
+			break;
 		}
-
-		// 2) Circle is between two lines but with a tiny radius
-		// TODO
+		futureMovement += remaining * firstTime;
+		if (std::find(hitBodies.begin(), hitBodies.end(), firstHit) ==
+			hitBodies.end())
+			hitBodies.push_back(firstHit);
+		// Keep what is left of the movement along the contact surface
+		remaining = remaining * (1.0f - firstTime);
+		remaining = remaining - firstNormal * glm::dot(remaining, firstNormal);
 	}
-	return false;
 }
 
-bool GameEngine::_isLineLineCollision(LineInfo &lineA, LineInfo &lineB) {
-	// Easy: If both line are vertical
-	if (lineA.isVertical && lineB.isVertical) {
-		return lineA.startX == lineB.startX;
-	}
+bool GameEngine::_sweepShape(Entity *entity, glm::vec3 const &position,
+							 glm::vec3 const &movement, Entity *other,
+							 float gap, float &time, glm::vec3 &normal) const {
+	const Collider *collider = entity->getCollider();
+	const Collider *otherCollider = other->getCollider();
+	glm::vec3 origin = position - other->getPosition();
+	origin.y = 0.0f;
+
+	// Grow the other shape by ours (Minkowski sum) and sweep our center
+	if (collider->shape == Collider::Rectangle &&
+		otherCollider->shape == Collider::Rectangle)
+		return _sweepRoundedBox(origin, movement,
+								collider->width + otherCollider->width + gap,
+								collider->height + otherCollider->height + gap,
+								0.0f, time, normal);
+	else if (collider->shape == Collider::Circle &&
+			 otherCollider->shape == Collider::Rectangle)
+		return _sweepRoundedBox(origin, movement, otherCollider->width,
+								otherCollider->height, collider->width + gap,
+								time, normal);
+	else if (collider->shape == Collider::Rectangle &&
+			 otherCollider->shape == Collider::Circle)
+		return _sweepRoundedBox(origin, movement, collider->width,
+								collider->height, otherCollider->width + gap,
+								time, normal);
+	return _sweepRoundedBox(origin, movement, 0.0f, 0.0f,
+							collider->width + otherCollider->width + gap, time,
+							normal);
+}
 
-	// Easy: If lines are parallel
-	if (lineA.m == lineB.m) {
-		return lineA.q == lineB.q;
+bool GameEngine::_sweepRoundedBox(glm::vec3 const &origin,
+								  glm::vec3 const &movement, float halfWidth,
+								  float halfHeight, float radius, float &time,
+								  glm::vec3 &normal) const {
+	float time1;
+	glm::vec3 normal1;
+	bool hasHit = false;
+
+	// Already inside (distance field), only block movements going deeper
+	float qX = abs(origin.x) - halfWidth;
+	float qZ = abs(origin.z) - halfHeight;
+	float outside =
+		sqrt(pow(std::max(qX, 0.0f), 2) + pow(std::max(qZ, 0.0f), 2));
+	if (outside + std::min(std::max(qX, qZ), 0.0f) - radius < 0.0f) {
+		float signX = origin.x < 0.0f ? -1.0f : 1.0f;
+		float signZ = origin.z < 0.0f ? -1.0f : 1.0f;
+		if (outside > 0.0f)
+			normal = glm::vec3(signX * std::max(qX, 0.0f), 0.0f,
+							   signZ * std::max(qZ, 0.0f)) /
+					 outside;
+		else if (qX > qZ)
+			normal = glm::vec3(signX, 0.0f, 0.0f);
+		else
+			normal = glm::vec3(0.0f, 0.0f, signZ);
+		time = 0.0f;
+		return glm::dot(movement, normal) < 0.0f;
 	}
 
-	float intersectionPointX = (lineB.q - lineA.q) / (lineA.m - lineB.m);
-	// Only truly collide if intersec point is between start/end
-	if ((lineA.startX <= intersectionPointX &&
-		 intersectionPointX <= lineA.endX) ||
-		(lineA.endX <= intersectionPointX &&
-		 intersectionPointX <= lineA.startX)) {
-		// Do same thing for other line
-		if ((lineB.startX <= intersectionPointX &&
-			 intersectionPointX <= lineB.endX) ||
-			(lineB.endX <= intersectionPointX &&
-			 intersectionPointX <= lineB.startX)) {
-			return true;
+	// Rounded box is the union of two crossed boxes and four corner circles
+	time = 1.0f;
+	if (_sweepBox(origin, movement, halfWidth + radius, halfHeight, time1,
+				  normal1) &&
+		time1 <= time) {
+		hasHit = true;
+		time = time1;
+		normal = normal1;
+	}
+	if (_sweepBox(origin, movement, halfWidth, halfHeight + radius, time1,
+				  normal1) &&
+		time1 <= time) {
+		hasHit = true;
+		time = time1;
+		normal = normal1;
+	}
+	if (radius <= 0.0f) return hasHit;
+	for (float cornerX : {-halfWidth, halfWidth}) {
+		for (float cornerZ : {-halfHeight, halfHeight}) {
+			if (_sweepCircle(origin - glm::vec3(cornerX, 0.0f, cornerZ),
+							 movement, radius, time1, normal1) &&
+				time1 <= time) {
+				hasHit = true;
+				time = time1;
+				normal = normal1;
+			}
 		}
 	}
-
-	return false;
+	return hasHit;
 }
 
-bool GameEngine::_isLineCircleCollision(LineInfo &lineA, float &xSquareCoeff,
-										float &xCoeff, float &zSquareCoeff,
-										float &zCoeff, float &cCoeff) {
-	xSquareCoeff += zSquareCoeff * pow(lineA.m, 2);
-	xCoeff += zSquareCoeff * (2 * lineA.m * lineA.q);
-	cCoeff += zSquareCoeff * pow(lineA.q, 2);
-	xCoeff += zCoeff * lineA.m;
-	cCoeff += zCoeff * lineA.q;
-
-	float delta = pow(xCoeff, 2) - 4 * xSquareCoeff * cCoeff;
-	if (delta < 0) return false;
-	delta = sqrt(delta);
-	float intersectionPointX = (-xCoeff + delta) / (2 * xSquareCoeff);
-	// Point really collides only if is inside line's start/end point
-	if ((lineA.startX <= intersectionPointX &&
-		 intersectionPointX <= lineA.endX) ||
-		(lineA.endX <= intersectionPointX &&
-		 intersectionPointX <= lineA.startX)) {
-		return true;
-	}
-	if (delta > 0) {
-		intersectionPointX = (-xCoeff - delta) / (2 * xSquareCoeff);
-		if ((lineA.startX <= intersectionPointX &&
-			 intersectionPointX <= lineA.endX) ||
-			(lineA.endX <= intersectionPointX &&
-			 intersectionPointX <= lineA.startX)) {
-			return true;
+bool GameEngine::_sweepBox(glm::vec3 const &origin, glm::vec3 const &movement,
+						   float halfWidth, float halfHeight, float &time,
+						   glm::vec3 &normal) const {
+	if (halfWidth <= 0.0f || halfHeight <= 0.0f) return false;
+	float entry = -INFINITY;
+	float exit = INFINITY;
+	const float halfSizes[2] = {halfWidth, halfHeight};
+	const float origins[2] = {origin.x, origin.z};
+	const float movements[2] = {movement.x, movement.z};
+
+	// Slab method, intersect the entry and exit times of both axes
+	for (int axis = 0; axis < 2; axis++) {
+		if (movements[axis] == 0.0f) {
+			if (abs(origins[axis]) >= halfSizes[axis]) return false;
+			continue;
+		}
+		float near = (-halfSizes[axis] - origins[axis]) / movements[axis];
+		float far = (halfSizes[axis] - origins[axis]) / movements[axis];
+		if (near > far) std::swap(near, far);
+		if (near > entry) {
+			entry = near;
+			normal = axis == 0
+						 ? glm::vec3(movements[axis] > 0.0f ? -1.0f : 1.0f,
+									 0.0f, 0.0f)
+						 : glm::vec3(0.0f, 0.0f,
+									 movements[axis] > 0.0f ? -1.0f : 1.0f);
 		}
+		exit = std::min(exit, far);
 	}
-	return false;
+	if (entry > exit || entry < 0.0f || entry > 1.0f) return false;
+	time = entry;
+	return true;
+}
+
+bool GameEngine::_sweepCircle(glm::vec3 const &origin,
+							  glm::vec3 const &movement, float radius,
+							  float &time, glm::vec3 &normal) const {
+	// Solve |origin + t * movement| = radius for the smallest t
+	float a = glm::dot(movement, movement);
+	float b = glm::dot(origin, movement);
+	float c = glm::dot(origin, origin) - radius * radius;
+	if (a == 0.0f || b >= 0.0f) return false;
+	float discriminant = b * b - a * c;
+	if (discriminant < 0.0f) return false;
+	float entry = (-b - sqrt(discriminant)) / a;
+	if (entry < 0.0f || entry > 1.0f) return false;
+	time = entry;
+	normal = glm::normalize(origin + movement * entry);
+	return true;
 }
+
 bool GameEngine::_doCollide(const Collider *colliderA, const glm::vec3 &posA,
 							Entity *entityB) const {
 	const Collider *colliderB = entityB->getCollider();
@@ -923,146 +1170,12 @@ bool GameEngine::_collisionCircleRectangle(
 			EPSILON);
 }
 
-bool GameEngine::_tryShortcut(
-	Entity *entity, glm::vec3 &futureMovement, glm::vec3 &shortcutMovement,
-	Entity *toAvoid, std::vector<Entity *> &possibleCollisionEntities) {
-	size_t idxOfCollision;
-
-	float absX = abs(futureMovement.x);
-	float absZ = abs(futureMovement.z);
-	// Try moving indipendently one of the two axis
-	// (Only if its a two-axis move)
-	if (futureMovement.x != 0.0f && futureMovement.z != 0.0f) {
-		shortcutMovement.x = futureMovement.x;
-		shortcutMovement.z = 0.0f;
-		idxOfCollision = _checkCollision(entity, shortcutMovement,
-										 possibleCollisionEntities);
-		if (idxOfCollision == possibleCollisionEntities.size()) {
-			return true;
-		}
-		shortcutMovement.x = 0.0f;
-		shortcutMovement.z = futureMovement.z;
-		idxOfCollision = _checkCollision(entity, shortcutMovement,
-										 possibleCollisionEntities);
-		if (idxOfCollision == possibleCollisionEntities.size()) {
-			return true;
-		}
-	}
-
-	// Special cases for Circle, will be able to
-	// "circle around" obstacles more easily if more
-	// than half is outside collision
-	if (entity->getCollider()->shape == Collider::Circle) {
-		// Only try to move along the most important
-		// targetMovement
-		if (absX >= absZ) {
-			// Try slide under obstacle
-			float colliderZ =
-				toAvoid->getPosition().z + toAvoid->getCollider()->height;
-			if (entity->getPosition().z > colliderZ) {
-				shortcutMovement.z =
-					colliderZ -
-					(entity->getPosition().z - entity->getCollider()->height);
-				if (shortcutMovement.z > (absX / 2)) {
-					shortcutMovement.z = absX / 2;
-				}
-				if (shortcutMovement.z < 0.0f)
-					shortcutMovement.z = EPSILON;
-				else if (shortcutMovement.z < EPSILON)
-					shortcutMovement.z += EPSILON;
-				// Move along X will be less than Z
-				// so that no collision will occur
-				shortcutMovement.x = shortcutMovement.z * 0.5f;
-				if (futureMovement.x < 0) shortcutMovement.x *= -1.0f;
-				if (_checkCollision(entity, shortcutMovement,
-									possibleCollisionEntities) ==
-					possibleCollisionEntities.size()) {
-					return true;
-				}
-			}
-			// Try slide over obstacle
-			colliderZ -= 2.0f * toAvoid->getCollider()->height;
-			if (entity->getPosition().z < colliderZ) {
-				shortcutMovement.z =
-					(entity->getPosition().z + entity->getCollider()->height) -
-					colliderZ;
-				if (shortcutMovement.z > (absX / 2)) {
-					shortcutMovement.z = absX / 2;
-				}
-				if (shortcutMovement.z < 0.0f)
-					shortcutMovement.z = EPSILON;
-				else if (shortcutMovement.z < EPSILON)
-					shortcutMovement.z += EPSILON;
-				// Move along X will be less than Z
-				// so that no collision will occur
-				shortcutMovement.x = shortcutMovement.z * 0.5f;
-				if (futureMovement.x < 0) shortcutMovement.x *= -1.0f;
-				shortcutMovement.z *= -1;
-				idxOfCollision = _checkCollision(entity, shortcutMovement,
-												 possibleCollisionEntities);
-				if (idxOfCollision == possibleCollisionEntities.size()) {
-					return true;
-				}
-			}
-		}
-		if (absZ >= absX) {
-			// Try slide right of obstacle
-			float colliderX =
-				toAvoid->getPosition().x + toAvoid->getCollider()->width;
-			if (entity->getPosition().x > colliderX) {
-				shortcutMovement.x = colliderX - (entity->getPosition().x -
-												  entity->getCollider()->width);
-				if (shortcutMovement.x > (absZ / 2)) {
-					shortcutMovement.x = absZ / 2;
-				}
-				if (shortcutMovement.x < 0.0f)
-					shortcutMovement.x = EPSILON;
-				else if (shortcutMovement.x < EPSILON)
-					shortcutMovement.x += EPSILON;
-				// Move along Z will be less than X
-				// so that no collision will occur
-				shortcutMovement.z = shortcutMovement.x * 0.5f;
-				if (futureMovement.z < 0) shortcutMovement.z *= -1.0f;
-				idxOfCollision = _checkCollision(entity, shortcutMovement,
-												 possibleCollisionEntities);
-				if (idxOfCollision == possibleCollisionEntities.size()) {
-					return true;
-				}
-			}
-			// Try slide over obstacle
-			colliderX -= 2.0f * toAvoid->getCollider()->width;
-			if (entity->getPosition().x < colliderX) {
-				shortcutMovement.x =
-					(entity->getPosition().x + entity->getCollider()->width) -
-					colliderX;
-				if (shortcutMovement.x > (absZ / 2)) {
-					shortcutMovement.x = absZ / 2;
-				}
-				if (shortcutMovement.x < 0.0f)
-					shortcutMovement.x = EPSILON;
-				else if (shortcutMovement.x < EPSILON)
-					shortcutMovement.x += EPSILON;
-				// Move along X will be less than Z
-				// so that no collision will occur
-				shortcutMovement.z = shortcutMovement.x * 0.5f;
-				if (futureMovement.z < 0) shortcutMovement.z *= -1.0f;
-				shortcutMovement.x *= -1;
-				idxOfCollision = _checkCollision(entity, shortcutMovement,
-												 possibleCollisionEntities);
-				if (idxOfCollision == possibleCollisionEntities.size()) {
-					return true;
-				}
-			}
-		}
-	}
-	return false;
-}
-
 void GameEngine::_setNewResolution() {
 	_gameRenderer->setNewResolution(_game->isFullScreen(),
 									_game->getWindowWidth(),
 									_game->getWindowHeight());
-	_camera->configGUI(_gameRenderer->getGUI());
+	_gameRenderer->setRenderQuality(_game->getRenderQuality());
+	if (!_headless) _camera->configGUI(_gameRenderer->getGUI());
 	for (auto entity : _allEntities) {
 		entity->updateModel();
 	}
@@ -1070,18 +1183,17 @@ void GameEngine::_setNewResolution() {
 }
 
 void GameEngine::updateMusicVolume(int newValue) {
-	_audioManager->updateMusicVolume(newValue);
+	if (_audioManager) _audioManager->updateMusicVolume(newValue);
 }
 void GameEngine::updateSoundsVolume(int newValue) {
-	_audioManager->updateSoundsVolume(newValue);
+	if (_audioManager) _audioManager->updateSoundsVolume(newValue);
 }
 
 void GameEngine::buttonStateChanged(int keyID, bool isPressed) {
-	if (_keyboardMap.find(keyID) == _keyboardMap.end()) {
-		KeyState keyState;
-		_keyboardMap[keyID] = keyState;
-	}
-	_keyboardMap[keyID].currFrame = isPressed;
+	KeyState &keyState = _keyboardMap[keyID];
+	// Latched until a tick runs, a frame may have none
+	if (isPressed && !keyState.currFrame) keyState.tickPressed = true;
+	keyState.currFrame = isPressed;
 }
 
 bool GameEngine::isKeyPressed(int keyID) {
@@ -1091,15 +1203,17 @@ bool GameEngine::isKeyPressed(int keyID) {
 
 bool GameEngine::isKeyJustPressed(int keyID) {
 	auto result = _keyboardMap.find(keyID);
-	return result != _keyboardMap.end() && result->second.currFrame &&
-		   !result->second.prevFrame;
+	if (result == _keyboardMap.end()) return false;
+	// Ticks and frames both see each press once, whatever their number
+	if (_isRunningTick) return result->second.tickPressed;
+	return result->second.currFrame && !result->second.prevFrame;
 }
 
 void GameEngine::playMusic(std::string musicPath) {
-	_audioManager->playMusic(musicPath);
+	if (_audioManager) _audioManager->playMusic(musicPath);
 }
 void GameEngine::playSound(std::string soundName) {
-	_audioManager->playSound(soundName);
+	if (_audioManager) _audioManager->playSound(soundName);
 }
 
 std::map<int, KeyState> GameEngine::_keyboardMap = std::map<int, KeyState>();
@@ -7,12 +7,21 @@
 extern std::string _srcsDir;
 extern std::string _assetsDir;
 
-GameRenderer::GameRenderer(GameEngine *gameEngine, AGame *game)
+GameRenderer::GameRenderer(GameEngine *gameEngine, AGame *game,
+						   bool headless)
 	: _game(game),
+	  _headless(headless),
 	  _isFullScreen(game->isFullScreen()),
 	  _widthRequested(game->getWindowWidth()),
-	  _heightRequested(game->getWindowHeight()) {
+	  _heightRequested(game->getWindowHeight()),
+	  _quality(game->getRenderQuality()) {
 	_gameEngine = gameEngine;
+	// No window nor GL context, sizes are only kept for game code queries
+	if (_headless) {
+		_width = _widthRequested;
+		_height = _heightRequested;
+		return;
+	}
 	glfwSetErrorCallback(errorCallback);
 	if (!glfwInit()) throw std::runtime_error("Failed to initialize GLFW");
 	glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
@@ -23,7 +32,8 @@ GameRenderer::GameRenderer(GameEngine *gameEngine, AGame *game)
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 	glfwWindowHint(GLFW_FOCUSED, GL_TRUE);
-	glfwWindowHint(GLFW_SAMPLES, 4);
+	// Only the GUI is drawn to the window, the scene target is multisampled
+	glfwWindowHint(GLFW_SAMPLES, 0);
 
 	_initWindow();
 }
@@ -32,11 +42,15 @@ GameRenderer::~GameRenderer(void) {
 	if (_graphicUI) delete _graphicUI;
 	for (auto model : _models) delete model.second;
 	_models.clear();
-	if (_shaderProgram) delete _shaderProgram;
-	if (_shadowShaderProgram) delete _shadowShaderProgram;
+	if (_shaderVariants) delete _shaderVariants;
+	if (_shadowShaderVariants) delete _shadowShaderVariants;
 	if (_skyboxShaderProgram) delete _skyboxShaderProgram;
+	if (_instanceVBO) glDeleteBuffers(1, &_instanceVBO);
+	if (_frameUBO) glDeleteBuffers(1, &_frameUBO);
+	_deleteSceneTarget();
+	if (!_headless) _dynamicResolution.release();
 	if (_window) glfwDestroyWindow(_window);
-	glfwTerminate();
+	if (!_headless) glfwTerminate();
 }
 
 void GameRenderer::_initWindow(void) {
@@ -73,6 +87,10 @@ void GameRenderer::_initWindow(void) {
 	_initGUI();
 	_initDepthMap();  // TODO Check if the Framebuffer was create correctly
 	_initShader();
+	_initInstanceBuffer();
+	_initFrameBuffer();
+	_dynamicResolution.init();
+	_dynamicResolution.reset(_quality.renderScale, _quality.dynamicResolution);
 }
 
 void GameRenderer::_initGUI() {
@@ -83,31 +101,51 @@ void GameRenderer::_initGUI() {
 }
 
 bool GameRenderer::_initDepthMap(void) {
-	// Create framebuffer object for rendering the depth map
-	glGenFramebuffers(1, &_depthMapFBO);
+	// New maps are empty, draw static casters again
+	_isShadowCacheValid = false;
+	_cascadeCount = std::min<size_t>(
+		std::max(_quality.shadowCascades, 1), MAX_SHADOW_CASCADES);
+	return _initDepthTarget(_depthMapFBOs, _depthMap) &&
+		   _initDepthTarget(_staticDepthMapFBOs, _staticDepthMap);
+}
 
-	// Create a 2D texture that we'll use as the framebuffer's depth buffer
-	glGenTextures(1, &_depthMap);
-	glBindTexture(GL_TEXTURE_2D, _depthMap);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_W, SHADOW_H, 0,
+bool GameRenderer::_initDepthTarget(GLuint *fbos, GLuint &texture) {
+	for (size_t idx = 0; idx < MAX_SHADOW_CASCADES; idx++) {
+		if (fbos[idx]) glDeleteFramebuffers(1, &fbos[idx]);
+		fbos[idx] = 0;
+	}
+	if (texture) glDeleteTextures(1, &texture);
+
+	// Create a 2D texture array with one layer per cascade that we'll use as
+	// the framebuffers depth buffer
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT,
+				 _quality.shadowSize, _quality.shadowSize, _cascadeCount, 0,
 				 GL_DEPTH_COMPONENT, GL_FLOAT, 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-	// Attach depth texture as the framebuffer's depth buffer
-	glBindFramebuffer(GL_FRAMEBUFFER, _depthMapFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
-						   _depthMap, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR,
+					 borderColor);
+
+	// Create one framebuffer object per layer for rendering the depth map
+	bool isComplete = true;
+	glGenFramebuffers(_cascadeCount, fbos);
+	for (size_t idx = 0; idx < _cascadeCount; idx++) {
+		glBindFramebuffer(GL_FRAMEBUFFER, fbos[idx]);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture,
+								  0, idx);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		// Always check that our framebuffer is ok
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			isComplete = false;
+	}
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	// Always check that our framebuffer is ok
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+	if (!isComplete) {
 		std::cerr << "Failed to initialize Depth Map." << std::endl;
 		return false;
 	}
@@ -115,30 +153,144 @@ bool GameRenderer::_initDepthMap(void) {
 }
 
 void GameRenderer::_initShader(void) {
-	if (_shaderProgram) delete _shaderProgram;
-	if (_shadowShaderProgram) delete _shadowShaderProgram;
+	if (_shaderVariants) delete _shaderVariants;
+	if (_shadowShaderVariants) delete _shadowShaderVariants;
 	if (_skyboxShaderProgram) delete _skyboxShaderProgram;
-	_shaderProgram = new ShaderProgram(_srcsDir + "engine/shaders/default.vs",
-									   _srcsDir + "engine/shaders/default.fs");
-	_shadowShaderProgram =
-		new ShaderProgram(_srcsDir + "engine/shaders/depthMap.vs",
-						  _srcsDir + "engine/shaders/depthMap.fs");
+	// Shadow filtering is unrolled for the quality tier kernel
+	_shaderVariants = new ShaderVariants(
+		_srcsDir + "engine/shaders/default.vs",
+		_srcsDir + "engine/shaders/default.fs", FeatureRigged | FeatureTextured,
+		{"PCF_RADIUS " + std::to_string(_quality.pcfRadius)});
+	// Depth only needs positions, textures are left out
+	_shadowShaderVariants =
+		new ShaderVariants(_srcsDir + "engine/shaders/depthMap.vs",
+						   _srcsDir + "engine/shaders/depthMap.fs",
+						   FeatureRigged);
 
 	_skyboxShaderProgram =
 		new ShaderProgram(_srcsDir + "engine/shaders/skybox.vs",
 						  _srcsDir + "engine/shaders/skybox.fs");
 
-	glUseProgram(_shaderProgram->getID());
-	_shaderProgram->setInt("shadowMap", 0);
-
-	glUseProgram(_shaderProgram->getID());
-	_shaderProgram->setInt("diffuseTexture", 1);
+	_shaderVariants->setInt("shadowMap", 0);
+	_shaderVariants->setInt("diffuseTexture", 1);
 
 	glUseProgram(_skyboxShaderProgram->getID());
 	_skyboxShaderProgram->setInt("skybox", 2);
 }
 
+void GameRenderer::_initInstanceBuffer(void) {
+	// Storage is (re)allocated by each batch upload
+	if (_instanceVBO) glDeleteBuffers(1, &_instanceVBO);
+	glGenBuffers(1, &_instanceVBO);
+}
+
+void GameRenderer::_initFrameBuffer(void) {
+	if (_frameUBO) glDeleteBuffers(1, &_frameUBO);
+	glGenBuffers(1, &_frameUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, _frameUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr,
+				 GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, _frameUBO);
+}
+
+void GameRenderer::_initSceneTarget(void) {
+	_deleteSceneTarget();
+	// Allocated for the tier scale, dynamic resolution uses a part of it
+	_sceneWidth = std::max(1, static_cast<int>(_width * _quality.renderScale));
+	_sceneHeight =
+		std::max(1, static_cast<int>(_height * _quality.renderScale));
+	GLint maxSamples = 0;
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+	GLsizei samples = std::min(_quality.msaaSamples, maxSamples);
+
+	glGenFramebuffers(1, &_sceneFBO);
+	glGenRenderbuffers(2, _sceneBuffers);
+	glBindRenderbuffer(GL_RENDERBUFFER, _sceneBuffers[0]);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8,
+									 _sceneWidth, _sceneHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, _sceneBuffers[1]);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples,
+									 GL_DEPTH_COMPONENT24, _sceneWidth,
+									 _sceneHeight);
+	glBindFramebuffer(GL_FRAMEBUFFER, _sceneFBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+							  GL_RENDERBUFFER, _sceneBuffers[0]);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+							  GL_RENDERBUFFER, _sceneBuffers[1]);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "\033[0;33m:Warning:\033[0m Failed to initialize the "
+					 "scene target."
+				  << std::endl;
+
+	// Samples can't be scaled by a blit, they are resolved at scene size
+	if (samples > 0) {
+		glGenFramebuffers(1, &_resolveFBO);
+		glGenRenderbuffers(1, &_resolveBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, _resolveBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, _sceneWidth,
+							  _sceneHeight);
+		glBindFramebuffer(GL_FRAMEBUFFER, _resolveFBO);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+								  GL_RENDERBUFFER, _resolveBuffer);
+	}
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	_isSceneTargetValid = true;
+}
+
+void GameRenderer::_deleteSceneTarget(void) {
+	if (_sceneFBO) glDeleteFramebuffers(1, &_sceneFBO);
+	if (_sceneBuffers[0]) glDeleteRenderbuffers(2, _sceneBuffers);
+	if (_resolveFBO) glDeleteFramebuffers(1, &_resolveFBO);
+	if (_resolveBuffer) glDeleteRenderbuffers(1, &_resolveBuffer);
+	_sceneFBO = 0;
+	_sceneBuffers[0] = 0;
+	_sceneBuffers[1] = 0;
+	_resolveFBO = 0;
+	_resolveBuffer = 0;
+}
+
+void GameRenderer::_presentScene(int sceneWidth, int sceneHeight) {
+	GLuint sourceFBO = _sceneFBO;
+	if (_resolveFBO) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, _sceneFBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _resolveFBO);
+		glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, sceneWidth,
+						  sceneHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		sourceFBO = _resolveFBO;
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, _width, _height,
+					  GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GameRenderer::setRenderQuality(RenderQuality const &quality) {
+	bool isShadowChanged = quality.shadowSize != _quality.shadowSize ||
+						   quality.shadowCascades != _quality.shadowCascades ||
+						   quality.pcfRadius != _quality.pcfRadius;
+	bool isTargetChanged = quality.msaaSamples != _quality.msaaSamples ||
+						   quality.renderScale != _quality.renderScale;
+	bool isScaleChanged =
+		quality.renderScale != _quality.renderScale ||
+		quality.dynamicResolution != _quality.dynamicResolution;
+	if (!isShadowChanged && !isTargetChanged && !isScaleChanged) return;
+	_quality = quality;
+	if (_headless) return;
+	if (isShadowChanged) {
+		_initDepthMap();
+		_initShader();
+	}
+	if (isTargetChanged) _isSceneTargetValid = false;
+	if (isScaleChanged)
+		_dynamicResolution.reset(_quality.renderScale,
+								 _quality.dynamicResolution);
+}
+
 void GameRenderer::loadAssets(std::map<std::string, ModelInfo> resources) {
+	if (_headless) return;
 	// Find old models that are no longer needed
 	for (auto &elem : _models) {
 		if (resources.find(elem.first) == resources.end()) {
@@ -159,6 +311,9 @@ void GameRenderer::loadAssets(std::map<std::string, ModelInfo> resources) {
 }
 
 void GameRenderer::initModelsMeshes(void) {
+	if (_headless) return;
+	// A new scene, nothing cached from the last one is valid
+	_isShadowCacheValid = false;
 	// Free models that are no longer used
 	for (auto name : _toDelete) {
 		if (_models[name] != nullptr) {
@@ -170,104 +325,368 @@ void GameRenderer::initModelsMeshes(void) {
 
 	// Init each remaining model
 	for (auto model : _models) {
-		model.second->initModel();
+		model.second->initModel(_instanceVBO);
 	}
 }
 
-void GameRenderer::getUserInput(void) { glfwPollEvents(); }
+void GameRenderer::getUserInput(void) {
+	if (!_headless) glfwPollEvents();
+}
 
 void GameRenderer::refreshWindow(std::vector<Entity *> &entities,
 								 Camera *camera, Light *light, Skybox *skybox) {
-	// Custom OpenGL state
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-	glEnable(GL_MULTISAMPLE);
+	if (_headless) return;
+	// Loaders and GUI setup touch OpenGL between frames
+	_glState.invalidate();
+	_glState.resetCounters();
+
+	// Custom OpenGL state, the GUI sets its own
+	_glState.enable(GL_DEPTH_TEST);
+	_glState.enable(GL_CULL_FACE);
+	_glState.enable(GL_MULTISAMPLE);
+	_glState.disable(GL_BLEND);
+	_glState.disable(GL_SCISSOR_TEST);
+	_glState.depthFunc(GL_LESS);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	_lightSpaceMatrix = light->getProjectionMatrix() * light->getViewMatrix();
-	// Shadow map
-	glUseProgram(_shadowShaderProgram->getID());
-	glViewport(0, 0, SHADOW_W, SHADOW_H);
-	glBindFramebuffer(GL_FRAMEBUFFER, _depthMapFBO);
-	glClear(GL_DEPTH_BUFFER_BIT);
-	_shadowShaderProgram->setMat4("lightSpaceMatrix", _lightSpaceMatrix);
-	glCullFace(GL_FRONT);
-	for (auto entity : entities) {
-		if (!entity->doShowModel()) continue;
-		_shadowShaderProgram->setMat4("M", entity->getModelMatrix());
-		Model *model = entity->getModel();
-		if (model && model->isRigged() && entity->shouldBeAnimated)
-			model->updateBoneTransforms(
-				&entity->currentAnimTime, entity->currentAnimName,
-				entity->loopAnim, _gameEngine->getDeltaTime(),
-				entity->currentAnimSpeed);
-		if (model) model->draw(*_shadowShaderProgram);
+	Profiler &profiler = _gameEngine->getProfiler();
+
+	// Draw entities in between the last two simulation ticks
+	float alpha = _gameEngine->getInterpolationAlpha();
+	glm::mat4 view = camera->getInterpolatedViewMatrix(alpha);
+
+	// Shadows keep the light and fits of the last static casters refresh
+	bool refreshStaticShadows =
+		_updateShadowCache(entities, light, view, camera->getProjectionMatrix());
+	// Uniforms shared by every program for this frame
+	FrameBlock frame;
+	frame.VP = camera->getProjectionMatrix() * view;
+	for (size_t idx = 0; idx < _cascadeCount; idx++) {
+		frame.lightSpaceMatrices[idx] = _shadowCascades.getMatrix(idx);
+		frame.cascadeSplits[idx] = _shadowCascades.getSplit(idx);
 	}
-	glCullFace(GL_BACK);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	frame.cascadeCount = _cascadeCount;
+	frame.skyboxVP =
+		camera->getProjectionMatrix() * glm::mat4(glm::mat3(view));
+	frame.viewPos = glm::vec4(camera->getInterpolatedPosition(alpha), 0.0f);
+	frame.lightDir = glm::vec4(light->getDir(), 0.0f);
+	frame.lightColor = glm::vec4(light->getColor(), 0.0f);
+	glBindBuffer(GL_UNIFORM_BUFFER, _frameUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &frame);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// Both passes draw from the same sorted queue
+	_buildRenderQueue(entities, view, frame.VP, refreshStaticShadows, alpha);
+	profiler.start(PhaseAnimation);
+	_updatePoses(entities);
+	profiler.stop(PhaseAnimation);
+
+	// Rebuilt here only, after all resolution and quality changes
+	if (!_isSceneTargetValid) _initSceneTarget();
+
+	// GPU time of the 3D passes drives the scene resolution
+	_dynamicResolution.beginFrame();
+	int sceneWidth = std::max(
+		1, static_cast<int>(_width * _dynamicResolution.getScale()));
+	int sceneHeight = std::max(
+		1, static_cast<int>(_height * _dynamicResolution.getScale()));
+	sceneWidth = std::min(sceneWidth, _sceneWidth);
+	sceneHeight = std::min(sceneHeight, _sceneHeight);
+
+	// Shadow maps, one layer per cascade
+	profiler.start(PhaseShadow);
+	glViewport(0, 0, _quality.shadowSize, _quality.shadowSize);
+	_glState.cullFace(GL_FRONT);
+	for (size_t idx = 0; idx < _cascadeCount; idx++) {
+		for (auto program : _shadowShaderVariants->getPrograms()) {
+			if (program == nullptr) continue;
+			_glState.useProgram(program->getID());
+			program->setInt(program->getDrawUniforms().cascadeIdx, idx);
+		}
+		// Items are only sorted out per cascade when there are several
+		Frustum const *frustum =
+			_cascadeCount > 1 ? &_cascadeFrustums[idx] : nullptr;
+		if (refreshStaticShadows) {
+			glBindFramebuffer(GL_FRAMEBUFFER, _staticDepthMapFBOs[idx]);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			_submitPass(PassStaticShadow, frustum);
+		}
+		// Start from the cached static casters and draw the moving ones on
+		// top
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, _staticDepthMapFBOs[idx]);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _depthMapFBOs[idx]);
+		glBlitFramebuffer(0, 0, _quality.shadowSize, _quality.shadowSize, 0, 0,
+						  _quality.shadowSize, _quality.shadowSize,
+						  GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, _depthMapFBOs[idx]);
+		_submitPass(PassShadow, frustum);
+	}
+	_glState.cullFace(GL_BACK);
+	profiler.stop(PhaseShadow);
 
 	// Basic rendering OpenGL state
-	glViewport(0, 0, _width, _height);
-	glDisable(GL_CULL_FACE);
+	profiler.start(PhaseMain);
+	glBindFramebuffer(GL_FRAMEBUFFER, _sceneFBO);
+	glViewport(0, 0, sceneWidth, sceneHeight);
+	_glState.disable(GL_CULL_FACE);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glUseProgram(_shaderProgram->getID());
-	_shaderProgram->setMat4(
-		"VP", camera->getProjectionMatrix() * camera->getViewMatrix());
-	_shaderProgram->setVec3("viewPos", camera->getPosition());
-	_shaderProgram->setVec3("lightDir", light->getDir());
-	_shaderProgram->setVec3("lightColor", light->getColor());
-	_shaderProgram->setMat4("lightSpaceMatrix", _lightSpaceMatrix);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, _depthMap);
-	for (auto entity : entities) {
-		if (!entity->doShowModel()) continue;
-		_shaderProgram->setMat4("M", entity->getModelMatrix());
-		Model *model = entity->getModel();
-		if (model && model->isRigged() && entity->shouldBeAnimated)
-			model->updateBoneTransforms(
-				&entity->currentAnimTime, entity->currentAnimName,
-				entity->loopAnim, 0.0, entity->currentAnimSpeed);
-		if (model) model->draw(*_shaderProgram, entity->getColor());
-	}
+	_glState.bindTexture(0, GL_TEXTURE_2D_ARRAY, _depthMap);
+	_submitPass(PassLit);
 
 	if (skybox != nullptr) {
 		// Skybox
-		glDepthFunc(GL_LEQUAL);
-		glUseProgram(_skyboxShaderProgram->getID());
-
-		_skyboxShaderProgram->setMat4(
-			"view", glm::mat4(glm::mat3(camera->getViewMatrix())));
-		_skyboxShaderProgram->setMat4("projection",
-									  camera->getProjectionMatrix());
-
-		glBindVertexArray(skybox->getVAO());
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->getTexture());
-		_skyboxShaderProgram->setInt("skybox", 2);
+		_glState.depthFunc(GL_LEQUAL);
+		_glState.useProgram(_skyboxShaderProgram->getID());
+
+		// Its sampler is set to unit 2 once in _initShader
+		_glState.bindVertexArray(skybox->getVAO());
+		_glState.bindTexture(2, GL_TEXTURE_CUBE_MAP, skybox->getTexture());
 		glDrawArrays(GL_TRIANGLES, 0, 36);
-		glBindVertexArray(0);
-		glDepthFunc(GL_LESS);  // Set depth function back to default
+		_glState.depthFunc(GL_LESS);  // Set depth function back to default
 	}
 
-	// Default OpenGL state
-	glUseProgram(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	// Default OpenGL state, bindings are left to the next user
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glDisable(GL_MULTISAMPLE);
-	glDisable(GL_DEPTH_TEST);
+	_glState.disable(GL_MULTISAMPLE);
+	// The GUI is drawn over it at the window resolution
+	_presentScene(sceneWidth, sceneHeight);
+	glViewport(0, 0, _width, _height);
+	_dynamicResolution.endFrame();
+	profiler.stop(PhaseMain);
 
+	profiler.start(PhaseGUI);
 	_graphicUI->nkNewFrame();
 	camera->drawGUI(_graphicUI);
+	if (profiler.isOverlayVisible()) profiler.drawGUI(_graphicUI, _width);
 	_graphicUI->nkRender();
+	profiler.stop(PhaseGUI);
+	profiler.setCounter(CounterStateIssued, _glState.getIssuedCount());
+	profiler.setCounter(CounterStateSkipped, _glState.getSkippedCount());
+	profiler.setCounter(CounterCulledShadow, _culledCounts[PassStaticShadow] +
+												 _culledCounts[PassShadow]);
+	profiler.setCounter(CounterCulledLit, _culledCounts[PassLit]);
+	profiler.setCounter(CounterGPUTime, static_cast<size_t>(
+											_dynamicResolution.getGPUTime() *
+											1000.0f));
+	if (_width > 0)
+		profiler.setCounter(CounterRenderScale,
+							static_cast<size_t>(sceneWidth * 100 / _width));
 
 	// Put everything to screen
 	glfwSwapBuffers(_window);
 }
 
+void GameRenderer::_buildRenderQueue(std::vector<Entity *> &entities,
+									 glm::mat4 const &view,
+									 glm::mat4 const &viewProjection,
+									 bool refreshStaticShadows, float alpha) {
+	InstanceData instance;
+	Frustum cameraFrustum(viewProjection);
+	// Casters out of the view may still throw a shadow inside it
+	_cascadeFrustums.clear();
+	for (size_t idx = 0; idx < _cascadeCount; idx++)
+		_cascadeFrustums.push_back(Frustum(_shadowCascades.getMatrix(idx)));
+
+	_renderQueue.clear();
+	_posedEntities.clear();
+	for (size_t &count : _culledCounts) count = 0;
+	for (auto entity : entities) {
+		if (!entity->doShowModel()) continue;
+		Model *model = entity->getModel();
+		if (!model) continue;
+		instance.model = entity->getInterpolatedModelMatrix(alpha);
+		instance.color = entity->getColor();
+		// Distance to the eye of each pass, to draw front to back
+		glm::vec4 position = instance.model[3];
+		bool isLit = cameraFrustum.isVisible(model->getBounds(), instance.model);
+		bool isShadowed = false;
+		RenderPass shadowPass =
+			_isCachedCaster(entity) ? PassStaticShadow : PassShadow;
+		// Static casters stay in the cached depth map until the next refresh
+		if (shadowPass == PassShadow || refreshStaticShadows) {
+			for (auto const &frustum : _cascadeFrustums) {
+				if (isShadowed) break;
+				isShadowed =
+					frustum.isVisible(model->getBounds(), instance.model);
+			}
+			if (isShadowed)
+				_renderQueue.add(shadowPass, *_shadowShaderVariants, entity,
+								 model, instance, -(_lightView * position).z);
+			else
+				_culledCounts[shadowPass]++;
+		}
+		if (isLit)
+			_renderQueue.add(PassLit, *_shaderVariants, entity, model,
+							 instance, -(view * position).z);
+		else
+			_culledCounts[PassLit]++;
+		if (model->isRigged() && (isLit || isShadowed))
+			_posedEntities.push_back(entity);
+	}
+	_renderQueue.sort();
+}
+
+void GameRenderer::_updatePoses(std::vector<Entity *> &entities) {
+	float deltaTime = _gameEngine->getDeltaTime();
+	// Culled entities keep playing, only their pose is not needed
+	for (auto entity : entities) {
+		Model *model = entity->getModel();
+		if (!entity->doShowModel() || !model || !model->isRigged()) continue;
+		model->bindClip(entity->currentAnimName, entity->getPose());
+		if (entity->shouldBeAnimated)
+			model->advanceAnimation(&entity->currentAnimTime,
+									entity->getPose(), entity->loopAnim,
+									deltaTime, entity->currentAnimSpeed);
+	}
+	// Palettes are written by the workers, the passes only upload them
+	_animationSystem.clear();
+	for (auto entity : _posedEntities)
+		_animationSystem.add(entity->getModel(), &entity->getPose(),
+							 entity->currentAnimTime);
+	_animationSystem.sample();
+}
+
+bool GameRenderer::_isStaticCaster(Entity *entity) const {
+	Collider const *collider = entity->getCollider();
+	return collider != nullptr && collider->isStatic &&
+		   !entity->getModel()->isRigged();
+}
+
+bool GameRenderer::_isCachedCaster(Entity *entity) const {
+	return _isStaticCaster(entity) &&
+		   _hiddenCasterIds.find(entity->getId()) == _hiddenCasterIds.end();
+}
+
+bool GameRenderer::_updateShadowCache(std::vector<Entity *> &entities,
+									  Light *light, glm::mat4 const &view,
+									  glm::mat4 const &projection) {
+	// Spawned or destroyed walls change the cached depth map as well, shown
+	// or not so that flickering ones don't
+	size_t casterCount = 0;
+	size_t casterHash = 0;
+	bool hasNewHiddenCaster = false;
+	bool hasBounds = false;
+	glm::vec3 sceneMin(0.0f);
+	glm::vec3 sceneMax(0.0f);
+	for (auto entity : entities) {
+		if (!entity->getModel()) continue;
+		if (_isStaticCaster(entity)) {
+			casterCount++;
+			// Ids restart with each scene, their positions tell layouts apart
+			glm::vec3 const &position = entity->getPosition();
+			for (size_t value :
+				 {entity->getId(), std::hash<float>()(position.x),
+				  std::hash<float>()(position.y),
+				  std::hash<float>()(position.z)})
+				casterHash ^= value + 0x9e3779b9 + (casterHash << 6) +
+							  (casterHash >> 2);
+			// Its first hide removes it from the cache, later ones are free
+			if (!entity->doShowModel() &&
+				_hiddenCasterIds.find(entity->getId()) ==
+					_hiddenCasterIds.end())
+				hasNewHiddenCaster = true;
+		}
+		if (!entity->doShowModel()) continue;
+		glm::vec3 center;
+		glm::vec3 halfExtents;
+		Frustum::getWorldBox(entity->getModel()->getBounds(),
+							 entity->getModelMatrix(), center, halfExtents);
+		sceneMin = hasBounds ? glm::min(sceneMin, center - halfExtents)
+							 : center - halfExtents;
+		sceneMax = hasBounds ? glm::max(sceneMax, center + halfExtents)
+							 : center + halfExtents;
+		hasBounds = true;
+	}
+	bool needsRefresh =
+		!_isShadowCacheValid || hasNewHiddenCaster ||
+		casterCount != _staticCasterCount ||
+		casterHash != _staticCasterHash ||
+		glm::dot(light->getDir(), _lightDir) <
+			cos(glm::radians(SHADOW_CACHE_ANGLE));
+	if (needsRefresh) {
+		_isShadowCacheValid = true;
+		_staticCasterCount = casterCount;
+		_staticCasterHash = casterHash;
+		// Casters shown again go back to the cache with this refresh
+		_hiddenCasterIds.clear();
+		for (auto entity : entities) {
+			if (entity->getModel() && !entity->doShowModel() &&
+				_isStaticCaster(entity))
+				_hiddenCasterIds.insert(entity->getId());
+		}
+		_lightDir = light->getDir();
+		_lightView = light->getViewMatrix();
+	}
+	// Fits are kept while they hold what the camera sees of the scene
+	if (_shadowCascades.update(_lightView, view, projection, sceneMin,
+							   sceneMax, _cascadeCount, needsRefresh))
+		needsRefresh = true;
+	return needsRefresh;
+}
+
+void GameRenderer::_submitPass(RenderPass pass, Frustum const *frustum) {
+	std::vector<DrawItem> const &items = _renderQueue.getItems();
+	ShaderProgram *program = nullptr;
+	Entity *posedEntity = nullptr;
+	size_t idx;
+	size_t end;
+
+	_renderQueue.getPassRange(pass, idx, end);
+	while (idx < end) {
+		DrawItem const &item = items[idx];
+		bool isNewProgram = item.program != program;
+		if (isNewProgram) {
+			program = item.program;
+			_glState.useProgram(program->getID());
+		}
+		// Each rigged entity has its own palette, sampled in _updatePoses,
+		// and its own draw calls
+		if (item.model->isRigged()) {
+			// Meshes of the same entity may use another variant
+			if (item.entity != posedEntity || isNewProgram) {
+				item.model->uploadPose(*program, item.entity->getPose());
+				posedEntity = item.entity;
+			}
+			_uploadInstances(&item.instance, 1);
+			item.mesh->draw(_glState, 1);
+			idx++;
+			continue;
+		}
+		// Same mesh items are next to each other once sorted
+		_instances.clear();
+		size_t batchEnd = idx;
+		while (batchEnd < end && items[batchEnd].mesh == item.mesh) {
+			DrawItem const &batchItem = items[batchEnd];
+			if (!frustum || frustum->isVisible(batchItem.model->getBounds(),
+											   batchItem.instance.model))
+				_instances.push_back(batchItem.instance);
+			batchEnd++;
+		}
+		idx = batchEnd;
+		if (_instances.empty()) continue;
+		_uploadInstances(&_instances.front(), _instances.size());
+		item.mesh->draw(_glState, _instances.size());
+	}
+}
+
+void GameRenderer::_uploadInstances(InstanceData const *instances,
+									size_t count) {
+	glBindBuffer(GL_ARRAY_BUFFER, _instanceVBO);
+	// Orphan the previous storage so we don't wait on pending draws using it
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData) * count, nullptr,
+				 GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceData) * count,
+					instances);
+}
+
 void GameRenderer::setNewResolution(bool isFullScreen, int width, int height) {
 	if (width <= 0 || height <= 0) return;
+	if (_headless) {
+		_isFullScreen = isFullScreen;
+		_widthRequested = _width = width;
+		_heightRequested = _height = height;
+		return;
+	}
 	if (isFullScreen == _isFullScreen && width == _widthRequested &&
 		height == _heightRequested)
 		return;
@@ -305,11 +724,12 @@ void GameRenderer::setNewResolution(bool isFullScreen, int width, int height) {
 		glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
 	}
 	glfwGetFramebufferSize(_window, &_width, &_height);
+	_isSceneTargetValid = false;
 }
 
 Model *GameRenderer::getModel(std::string modelName) const {
 	if (_models.find(modelName) != _models.end()) return _models.at(modelName);
-	if (!modelName.empty())
+	if (!modelName.empty() && !_headless)
 		std::cerr << "\033[0;33m:Warning:\033[0m " << modelName
 				  << " not found inside the models map." << std::endl;
 	return nullptr;
@@ -317,17 +737,22 @@ Model *GameRenderer::getModel(std::string modelName) const {
 
 GUI *GameRenderer::getGUI() { return _graphicUI; }
 
+GLState &GameRenderer::getGLState(void) { return _glState; }
+
 int GameRenderer::getWidth(void) const { return _widthRequested; }
 
 int GameRenderer::getHeight(void) const { return _heightRequested; }
 
 GLFWwindow *GameRenderer::getWindow(void) const { return _window; }
 
+bool GameRenderer::isHeadless(void) const { return _headless; }
+
 void GameRenderer::errorCallback(int error, const char *description) {
 	std::cerr << "Error n." << error << ": " << description << std::endl;
 }
 
 void GameRenderer::switchCursorMode(bool debug) const {
+	if (_headless) return;
 	glfwSetInputMode(_window, GLFW_CURSOR,
 					 debug ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
 }
@@ -8,7 +8,6 @@ Light::Light(glm::vec2 const &lightPos, glm::vec3 const &lightTarget,
 	  _target(lightTarget),
 	  _color(glm::vec3(1.0f)) {
 	_localOrientation = false;
-	_projection = glm::ortho<float>(-40.0f, 40.0f, -40.0f, 40.0f, 1.0f, 100.0f);
 	glm::vec3 tmp = (_target - getPosition());
 
 	_rotationAxis = glm::cross(glm::vec3(0.0, 1.0, 0.0),
@@ -27,8 +26,6 @@ glm::vec3 const &Light::getDir(void) const { return _dir; }
 
 glm::vec3 const &Light::getColor(void) const { return _color; }
 
-glm::mat4 const &Light::getProjectionMatrix(void) const { return _projection; }
-
 glm::mat4 const &Light::getViewMatrix(void) const { return _view; }
 
 void Light::update(void) {
@@ -1,19 +1,23 @@
 #include "engine/Mesh.hpp"
 
+size_t Mesh::_createdMeshes = 0;
+
 Mesh::Mesh(TextureInfo textureInfo, std::vector<Vertex> vertices,
 		   Material const &material)
-	: _size(vertices.size()),
+	: _id(Mesh::_createdMeshes++),
+	  _size(vertices.size()),
 	  _textureInfo(textureInfo),
 	  _vertices(vertices),
 	  _material(material) {}
 
 Mesh::~Mesh(void) {
 	if (_textureInfo.data != nullptr) stbi_image_free(_textureInfo.data);
-	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &VBO);
+	// Models loaded without a GL context (benchmarks) have no buffers
+	if (VAO) glDeleteVertexArrays(1, &VAO);
+	if (VBO) glDeleteBuffers(1, &VBO);
 }
 
-void Mesh::setupBuffers(void) {
+void Mesh::setupBuffers(GLuint instanceVBO) {
 	if (_vertices.size() == 0) return;
 
 	glGenVertexArrays(1, &VAO);
@@ -49,6 +53,22 @@ void Mesh::setupBuffers(void) {
 						  (void *)offsetof(Vertex, weights));
 	glEnableVertexAttribArray(4);
 
+	// Model matrix, one column per location, advanced once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	for (GLuint column = 0; column < 4; column++) {
+		glVertexAttribPointer(
+			5 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+			(void *)(offsetof(InstanceData, model) + sizeof(glm::vec4) * column));
+		glEnableVertexAttribArray(5 + column);
+		glVertexAttribDivisor(5 + column, 1);
+	}
+
+	// Tint color
+	glVertexAttribPointer(9, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+						  (void *)offsetof(InstanceData, color));
+	glEnableVertexAttribArray(9);
+	glVertexAttribDivisor(9, 1);
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 
@@ -75,33 +95,39 @@ void Mesh::setupTexture(void) {
 	_textureInfo.data = nullptr;
 }
 
-void Mesh::draw(ShaderProgram const &shaderProgram,
-				glm::vec3 const &color) const {
-	if (color.x != -1.0f && color.y != -1.0f && color.z != -1.0f) {
-		shaderProgram.setVec3("material.ambientColor",
-							  glm::mix(_material.ambientColor, color, 0.5));
-		shaderProgram.setVec3("material.diffuseColor",
-							  glm::mix(_material.diffuseColor, color, 0.5));
-		shaderProgram.setVec3("material.specularColor",
-							  glm::mix(_material.specularColor, color, 0.5));
-	} else {
-		shaderProgram.setVec3("material.ambientColor", _material.ambientColor);
-		shaderProgram.setVec3("material.diffuseColor", _material.diffuseColor);
-		shaderProgram.setVec3("material.specularColor",
-							  _material.specularColor);
-	}
-	shaderProgram.setFloat("material.shininess", _material.shininess);
-	shaderProgram.setBool("material.hasDiffuseTexture",
-						  _material.hasDiffuseTexture);
+void Mesh::draw(GLState &glState, GLsizei instanceCount) const {
+	// Tint colors come with the instances, see default.fs
+	glBindBufferRange(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, _materialUBO,
+					  _materialOffset, sizeof(MaterialBlock));
 
-	if (_material.hasDiffuseTexture) {
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, _diffuseTexture);
-	}
+	if (_material.hasDiffuseTexture)
+		glState.bindTexture(1, GL_TEXTURE_2D, _diffuseTexture);
 
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glDrawArrays(GL_TRIANGLES, 0, _size);
+	// The VAO already knows the vertex buffers
+	glState.bindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, _size, instanceCount);
+}
+
+MaterialBlock Mesh::getMaterialBlock(void) const {
+	MaterialBlock block;
+	block.ambientColor = _material.ambientColor;
+	block.shininess = _material.shininess;
+	block.diffuseColor = _material.diffuseColor;
+	block.padding0 = 0.0f;
+	block.specularColor = _material.specularColor;
+	block.padding1 = 0.0f;
+	return block;
 }
 
-size_t Mesh::getSize(void) const { return _size; }
\ No newline at end of file
+void Mesh::setMaterialRange(GLuint materialUBO, GLintptr offset) {
+	_materialUBO = materialUBO;
+	_materialOffset = offset;
+}
+
+size_t Mesh::getSize(void) const { return _size; }
+
+size_t Mesh::getId(void) const { return _id; }
+
+GLuint Mesh::getDiffuseTexture(void) const {
+	return _material.hasDiffuseTexture ? _diffuseTexture : 0;
+}
\ No newline at end of file
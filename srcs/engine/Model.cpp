@@ -1,5 +1,9 @@
 #include "engine/Model.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
 extern std::string _assetsDir;
 
 Model::Model(std::string const &modelPath)
@@ -16,74 +20,213 @@ Model::Model(std::string const &modelPath)
 	}
 	_processNode(scene->mRootNode, scene, glm::mat4(1.0f));
 	if (_joints.size() > 0) _rigged = true;
+	_computeBoundingSphere();
 	_buildSkeletonHierarchy(scene->mRootNode);
-	if (scene->HasAnimations()) {
-		_animated = true;
-		// Load first animation only...
-		for (size_t i = 0; i < 1 /*scene->mNumAnimations*/; i++) {
-			aiAnimation *anim = scene->mAnimations[i];
-			_animLengths["Idle"] = anim->mDuration;
-			for (size_t j = 0; j < anim->mNumChannels; j++) {
-				aiNodeAnim *nodeAnim = anim->mChannels[j];
-				Joint *joint = findJointByName(nodeAnim->mNodeName.C_Str());
-				if (joint != nullptr) {
-					joint->setPositionKeys("Idle", nodeAnim->mPositionKeys,
-										   nodeAnim->mNumPositionKeys);
-					joint->setRotationKeys("Idle", nodeAnim->mRotationKeys,
-										   nodeAnim->mNumRotationKeys);
-					joint->setScalingKeys("Idle", nodeAnim->mScalingKeys,
-										  nodeAnim->mNumScalingKeys);
-				}
-			}
-		}
-	}
+	// Load first animation only...
+	if (scene->HasAnimations()) _addClip("Idle", scene->mAnimations[0]);
 }
 
 Model::~Model(void) {
+	for (auto clip : _clips) delete clip;
 	for (auto joint : _joints) delete joint;
 	for (auto mesh : _meshes) delete mesh;
+	if (_materialUBO) glDeleteBuffers(1, &_materialUBO);
 }
 
 void Model::_buildSkeletonHierarchy(aiNode *rootNode) {
+	std::vector<size_t> depths(_joints.size(), 0);
 	for (auto joint : _joints) {
 		aiNode *node = _findNodeByName(joint->name, rootNode);
-		joint->localTransform = toGlmMat4(node->mTransformation);
-		Joint *parent = findJointByName(node->mParent->mName.C_Str());
-		joint->parent = parent;
+		if (node == nullptr) continue;
+		joint->bindTransform = toGlmMat4(node->mTransformation);
+		if (node->mParent != nullptr)
+			joint->parent = findJointByName(node->mParent->mName.C_Str());
+	}
+	for (auto joint : _joints) {
+		for (Joint *tmp = joint->parent; tmp != nullptr; tmp = tmp->parent)
+			depths[joint->index]++;
+	}
+	// Parents before their children, global transforms are then computed in
+	// a single forward pass
+	_skeletonOrder.resize(_joints.size());
+	std::iota(_skeletonOrder.begin(), _skeletonOrder.end(), 0);
+	std::stable_sort(_skeletonOrder.begin(), _skeletonOrder.end(),
+					 [&depths](size_t lhs, size_t rhs) {
+						 return depths[lhs] < depths[rhs];
+					 });
+	std::vector<int> positions(_joints.size());
+	for (size_t pos = 0; pos < _skeletonOrder.size(); pos++)
+		positions[_skeletonOrder[pos]] = pos;
+	_skeletonParents.resize(_joints.size());
+	for (size_t pos = 0; pos < _skeletonOrder.size(); pos++) {
+		Joint const *parent = _joints[_skeletonOrder[pos]]->parent;
+		_skeletonParents[pos] = parent ? positions[parent->index] : -1;
+	}
+	for (auto joint : _joints) {
+		_bindAffines.push_back(toAffine(joint->bindTransform));
+		_offsetAffines.push_back(toAffine(joint->offsetMatrix));
 	}
-	for (auto joint : _joints) joint->updateFinalTransform();
 }
 
-void Model::updateBoneTransforms(double *animTime, std::string &animName,
-								 bool loop, float deltaTime, float speed) {
-	if (_animated) {
-		double tmp = *animTime + deltaTime * speed;
-		if (tmp + EPSILON >= _animLengths[animName]) {
-			if (loop)
-				*animTime = 0.0;
-			else
-				*animTime = _animLengths[animName] - EPSILON;
-		} else
-			*animTime = tmp;
-		if (_animLengths.find(animName) == _animLengths.end()) {
-			std::cerr << "\033[0;33m:Warning:\033[0m " << animName
-					  << " not found inside the animations map. Replaced by "
-						 "the default one 'Idle'."
-					  << std::endl;
-			animName = "Idle";
-		}
-		for (auto joint : _joints)
-			joint->applyAnimationTransform(*animTime, animName);
+void Model::_addClip(std::string const &animName, aiAnimation const *anim) {
+	AnimationClip *clip = new AnimationClip(anim->mDuration, _joints.size());
+	for (size_t i = 0; i < anim->mNumChannels; i++) {
+		aiNodeAnim *nodeAnim = anim->mChannels[i];
+		Joint *joint = findJointByName(nodeAnim->mNodeName.C_Str());
+		if (joint != nullptr) clip->setTrack(joint->index, nodeAnim);
+	}
+	auto it = _clipIds.find(animName);
+	if (it != _clipIds.end()) {
+		delete _clips[it->second];
+		_clips[it->second] = clip;
+	} else {
+		_clipIds[animName] = _clips.size();
+		_clips.push_back(clip);
+	}
+	_animated = true;
+}
+
+void Model::bindClip(std::string &animName, Pose &pose) const {
+	if (pose.model == this && pose.animName == animName) return;
+	int clipId = getClipId(animName);
+	if (clipId < 0 && _animated) {
+		std::cerr << "\033[0;33m:Warning:\033[0m " << animName
+				  << " not found inside the animations map. Replaced by "
+					 "the default one 'Idle'."
+				  << std::endl;
+		animName = "Idle";
+		clipId = getClipId(animName);
+	}
+	pose.model = this;
+	pose.animName = animName;
+	pose.clipId = clipId;
+	pose.cursors.assign(_joints.size() * TrackCount, 0);
+	pose.sampledTime = -1.0;
+}
+
+void Model::advanceAnimation(double *animTime, Pose const &pose, bool loop,
+							 float deltaTime, float speed) const {
+	AnimationClip const *clip = getClip(pose.clipId);
+	if (clip == nullptr) return;
+	double tmp = *animTime + deltaTime * speed;
+	if (tmp + EPSILON >= clip->getDuration()) {
+		if (loop)
+			*animTime = 0.0;
+		else
+			*animTime = clip->getDuration() - EPSILON;
+	} else
+		*animTime = tmp;
+}
+
+void Model::samplePose(double animTime, Pose &pose) const {
+	if (pose.model != this || pose.sampledTime == animTime) return;
+	AnimationClip const *clip = getClip(pose.clipId);
+	// Unused joints keep the identity
+	pose.palette.resize(MAX_JOINTS, glm::mat4(1.0f));
+	pose.globals.resize(_joints.size());
+	for (size_t pos = 0; pos < _skeletonOrder.size(); pos++) {
+		size_t idx = _skeletonOrder[pos];
+		Joint const *joint = _joints[idx];
+		glm::mat4 local =
+			clip != nullptr && clip->hasTrack(idx)
+				? clip->sample(idx, animTime, &pose.cursors[idx * TrackCount])
+				: joint->bindTransform;
+		int parent = _skeletonParents[pos];
+		glm::mat4 const &parentGlobal =
+			parent < 0 ? _toYAxisUp : pose.globals[parent];
+		pose.globals[pos] = parentGlobal * local;
+		// Same products as walking up the parents from the axis fix-up
+		if (idx < MAX_JOINTS)
+			pose.palette[idx] = parentGlobal * (local * joint->offsetMatrix);
 	}
-	for (auto joint : _joints) joint->updateFinalTransform();
+	pose.sampledTime = animTime;
+}
+
+bool Model::needsSampling(double animTime, Pose const &pose) const {
+	return pose.model == this && pose.sampledTime != animTime;
 }
 
-void Model::initModel(void) {
+void Model::gatherKeys(double animTime, Pose &pose,
+					   KeyLanes *const *lanes) const {
+	AnimationClip const *clip = getClip(pose.clipId);
+	for (size_t pos = 0; pos < _skeletonOrder.size(); pos++) {
+		size_t idx = _skeletonOrder[pos];
+		if (clip != nullptr)
+			clip->gatherKeys(idx, animTime, &pose.cursors[idx * TrackCount],
+							 lanes);
+		else
+			AnimationClip::gatherIdentity(lanes);
+	}
+}
+
+void Model::composePalette(double animTime, Pose &pose, Affine const *locals,
+						   Affine *globals, bool useSSE) const {
+	static Affine const toYAxisUp = toAffine(_toYAxisUp);
+	AnimationClip const *clip = getClip(pose.clipId);
+	Affine final;
+	pose.palette.resize(MAX_JOINTS, glm::mat4(1.0f));
+	for (size_t pos = 0; pos < _skeletonOrder.size(); pos++) {
+		size_t idx = _skeletonOrder[pos];
+		Affine const &local = clip != nullptr && clip->hasTrack(idx)
+								  ? locals[pos]
+								  : _bindAffines[idx];
+		int parent = _skeletonParents[pos];
+		multiplyAffines(parent < 0 ? toYAxisUp : globals[parent], local,
+						globals[pos], useSSE);
+		if (idx >= MAX_JOINTS) continue;
+		multiplyAffines(globals[pos], _offsetAffines[idx], final, useSSE);
+		pose.palette[idx] = toMat4(final);
+	}
+	pose.sampledTime = animTime;
+}
+
+int Model::getClipId(std::string const &animName) const {
+	auto it = _clipIds.find(animName);
+	return it != _clipIds.end() ? it->second : -1;
+}
+
+std::map<std::string, int> const &Model::getClipIds(void) const {
+	return _clipIds;
+}
+
+AnimationClip const *Model::getClip(int clipId) const {
+	if (clipId < 0 || static_cast<size_t>(clipId) >= _clips.size())
+		return nullptr;
+	return _clips[clipId];
+}
+
+size_t Model::getJointCount(void) const { return _joints.size(); }
+
+void Model::initModel(GLuint instanceVBO) {
 	// Meshes
 	for (auto mesh : _meshes) {
 		mesh->setupTexture();
-		mesh->setupBuffers();
+		mesh->setupBuffers(instanceVBO);
 	}
+	if (_materialUBO == 0) _initMaterials();
+}
+
+void Model::_initMaterials(void) {
+	if (_meshes.empty()) return;
+	// Each mesh material gets its own aligned range of a single buffer
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	size_t stride = sizeof(MaterialBlock);
+	if (alignment > 0)
+		stride = (stride + alignment - 1) / alignment * alignment;
+	std::vector<char> data(stride * _meshes.size(), 0);
+	for (size_t idx = 0; idx < _meshes.size(); idx++) {
+		MaterialBlock block = _meshes[idx]->getMaterialBlock();
+		memcpy(&data[idx * stride], &block, sizeof(MaterialBlock));
+	}
+
+	glGenBuffers(1, &_materialUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, _materialUBO);
+	glBufferData(GL_UNIFORM_BUFFER, data.size(), &data.front(),
+				 GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	for (size_t idx = 0; idx < _meshes.size(); idx++)
+		_meshes[idx]->setMaterialRange(_materialUBO, idx * stride);
 }
 
 void Model::_loadDiffuseTexture(TextureInfo &textureInfo, aiMaterial *assimpMat,
@@ -140,6 +283,7 @@ Mesh *Model::_processMesh(aiMesh *mesh, const aiScene *scene,
 		vertex.position.x = position.x;
 		vertex.position.y = position.y;
 		vertex.position.z = position.z;
+		_extendBounds(vertex.position);
 		glm::vec4 normal =
 			transform * glm::vec4(mesh->mNormals[i].x, mesh->mNormals[i].y,
 								  mesh->mNormals[i].z, 0.0f);
@@ -210,19 +354,11 @@ void Model::_processNode(aiNode *node, const aiScene *scene,
 	}
 }
 
-void Model::draw(ShaderProgram const &shaderProgram, glm::vec3 const &color) {
-	shaderProgram.setBool("rigged", _rigged);
-	if (_rigged) {
-		for (size_t i = 0; i < 32; i++) {
-			shaderProgram.setMat4("boneTransforms[" + std::to_string(i) + "]",
-								  _joints.size() > i
-									  ? _joints[i]->finalTransform
-									  : glm::mat4(1.0f));
-		}
-	}
-	for (const auto mesh : _meshes) {
-		if (mesh != nullptr) mesh->draw(shaderProgram, color);
-	}
+void Model::uploadPose(ShaderProgram const &shaderProgram,
+						Pose const &pose) const {
+	if (!_rigged || pose.palette.size() < MAX_JOINTS) return;
+	shaderProgram.setMat4Array(shaderProgram.getDrawUniforms().boneTransforms,
+							   &pose.palette.front(), MAX_JOINTS);
 }
 
 void Model::addAnimation(std::string const &animName,
@@ -235,32 +371,47 @@ void Model::addAnimation(std::string const &animName,
 				  << importer.GetErrorString() << std::endl;
 		return;
 	}
-	if (scene->HasAnimations()) {
-		_animated = true;
-		// Only support one animation for now
-		for (size_t i = 0; i < 1 /*scene->mNumAnimations*/; i++) {
-			aiAnimation *anim = scene->mAnimations[i];
-			_animLengths[animName] = anim->mDuration;
-			for (size_t j = 0; j < anim->mNumChannels; j++) {
-				aiNodeAnim *nodeAnim = anim->mChannels[j];
-				Joint *joint = findJointByName(nodeAnim->mNodeName.C_Str());
-				if (joint != nullptr) {
-					joint->setPositionKeys(animName, nodeAnim->mPositionKeys,
-										   nodeAnim->mNumPositionKeys);
-					joint->setRotationKeys(animName, nodeAnim->mRotationKeys,
-										   nodeAnim->mNumRotationKeys);
-					joint->setScalingKeys(animName, nodeAnim->mScalingKeys,
-										  nodeAnim->mNumScalingKeys);
-				}
-			}
-		}
-	}
+	// Only support one animation for now
+	if (scene->HasAnimations()) _addClip(animName, scene->mAnimations[0]);
 }
 
-std::vector<Mesh *> const Model::getMeshes(void) const { return _meshes; }
+std::vector<Mesh *> const &Model::getMeshes(void) const { return _meshes; }
 
 bool Model::isRigged(void) const { return _rigged; }
 
+Bounds const &Model::getBounds(void) const { return _bounds; }
+
+void Model::_extendBounds(glm::vec3 const &position) {
+	if (!_hasBounds) {
+		_bounds.min = position;
+		_bounds.max = position;
+		_hasBounds = true;
+		return;
+	}
+	_bounds.min = glm::min(_bounds.min, position);
+	_bounds.max = glm::max(_bounds.max, position);
+}
+
+void Model::_computeBoundingSphere(void) {
+	if (_rigged) {
+		// Joints may rotate the bind pose around the origin (axis fix-up,
+		// animations), keep a volume centered on it that any rotation fits in
+		glm::vec3 farthest =
+			glm::max(glm::abs(_bounds.min), glm::abs(_bounds.max));
+		float radius = glm::length(farthest) * RIGGED_BOUNDS_MARGIN;
+		_bounds.min = glm::vec3(-radius);
+		_bounds.max = glm::vec3(radius);
+		_bounds.center = glm::vec3(0.0f);
+		_bounds.radius = radius;
+		return;
+	}
+	_bounds.center = (_bounds.min + _bounds.max) * 0.5f;
+	_bounds.radius = glm::length(_bounds.max - _bounds.center);
+}
+
+glm::mat4 const Model::_toYAxisUp = glm::rotate(
+	glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
+
 glm::mat4 Model::toGlmMat4(const aiMatrix4x4 &src) {
 	glm::mat4 dest;
 
@@ -0,0 +1,48 @@
+#include "engine/PoseBatch.hpp"
+
+PoseBatch::PoseBatch(bool useSSE)
+	: _useSSE(useSSE), _translations(3), _rotations(4), _scalings(3) {}
+
+PoseBatch::~PoseBatch(void) {}
+
+void PoseBatch::clear(void) { _entries.clear(); }
+
+void PoseBatch::add(Model const *model, Pose *pose, double animTime) {
+	if (!model->needsSampling(animTime, *pose)) return;
+	Entry entry;
+	entry.model = model;
+	entry.pose = pose;
+	entry.animTime = animTime;
+	entry.firstLane = 0;
+	_entries.push_back(entry);
+}
+
+void PoseBatch::sample(void) {
+	// Lanes of each kind in TrackKind order
+	KeyLanes *const lanes[TrackCount] = {&_translations, &_rotations,
+										 &_scalings};
+	for (auto lane : lanes) lane->clear();
+	for (auto &entry : _entries) {
+		entry.firstLane = _translations.size();
+		entry.model->gatherKeys(entry.animTime, *entry.pose, lanes);
+	}
+	size_t count = _translations.size();
+	lerpLanes(_translations, _results[TrackPosition], _useSSE);
+	nlerpLanes(_rotations, _results[TrackRotation], _useSSE);
+	lerpLanes(_scalings, _results[TrackScaling], _useSSE);
+	_locals.resize(count);
+	_globals.resize(count);
+	if (count > 0)
+		composeAffines(_results[TrackPosition], _results[TrackRotation],
+					   _results[TrackScaling], count, &_locals.front(),
+					   _useSSE);
+	for (auto &entry : _entries) {
+		entry.model->composePalette(entry.animTime, *entry.pose,
+									&_locals[entry.firstLane],
+									&_globals[entry.firstLane], _useSSE);
+	}
+}
+
+size_t PoseBatch::size(void) const { return _entries.size(); }
+
+size_t PoseBatch::getJointCount(void) const { return _translations.size(); }
@@ -0,0 +1,174 @@
+#include "engine/Profiler.hpp"
+#include "engine/GUI/GUI.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+Profiler::Profiler(size_t history) : _samples(std::max<size_t>(history, 1)) {
+	_current = Sample();
+}
+
+Profiler::~Profiler(void) {}
+
+void Profiler::beginFrame(void) {
+	_current = Sample();
+	_current.frame = _frameCount;
+	_frameStart = ProfilerClock::now();
+}
+
+void Profiler::endFrame(void) {
+	_current.phases[PhaseCount] =
+		std::chrono::duration<float, std::milli>(ProfilerClock::now() -
+												 _frameStart)
+			.count();
+	_samples[_nextSample] = _current;
+	_nextSample = (_nextSample + 1) % _samples.size();
+	if (_sampleCount < _samples.size()) _sampleCount++;
+	_frameCount++;
+}
+
+void Profiler::start(ProfilerPhase phase) {
+	_phaseStarts[phase] = ProfilerClock::now();
+}
+
+void Profiler::stop(ProfilerPhase phase) {
+	_current.phases[phase] +=
+		std::chrono::duration<float, std::milli>(ProfilerClock::now() -
+												 _phaseStarts[phase])
+			.count();
+}
+
+void Profiler::setCounter(ProfilerCounter counter, size_t value) {
+	_current.counters[counter] = value;
+}
+
+float Profiler::getPercentile(ProfilerPhase phase, float percent) const {
+	std::vector<float> values(_sampleCount);
+	for (size_t idx = 0; idx < _sampleCount; idx++)
+		values[idx] = _getSample(idx).phases[phase];
+	return _getPercentile(values, percent);
+}
+
+float Profiler::getCounterPercentile(ProfilerCounter counter,
+									 float percent) const {
+	std::vector<float> values(_sampleCount);
+	for (size_t idx = 0; idx < _sampleCount; idx++)
+		values[idx] = _getSample(idx).counters[counter];
+	return _getPercentile(values, percent);
+}
+
+size_t Profiler::getSampleCount(void) const { return _sampleCount; }
+
+bool Profiler::isOverlayVisible(void) const { return _isOverlayVisible; }
+
+void Profiler::toggleOverlay(void) { _isOverlayVisible = !_isOverlayVisible; }
+
+void Profiler::drawGUI(GUI *graphicUI, int windowWidth) const {
+	static const int rowHeight = 18;
+	static const int nameWidth = 130;
+	static const int valueWidth = 55;
+	int blockWidth = nameWidth + valueWidth * 3 + 30;
+	int blockHeight = rowHeight * (PhaseCount + CounterCount + 2) + 60;
+
+	if (graphicUI->uiStartBlock(
+			"profiler", "Profiler (ms)",
+			nk_rect(windowWidth - blockWidth - 10, 10, blockWidth, blockHeight),
+			NK_WINDOW_BORDER | NK_WINDOW_TITLE | NK_WINDOW_NO_SCROLLBAR |
+				NK_WINDOW_NO_INPUT)) {
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(2);
+		for (int phase = -1; phase <= PhaseCount; phase++) {
+			graphicUI->uiRowMultipleElem(true, rowHeight, 4);
+			graphicUI->uiAddElemInRow(nameWidth);
+			if (phase == -1) {
+				graphicUI->uiText("", NK_TEXT_LEFT);
+			} else {
+				graphicUI->uiText(
+					getPhaseName(static_cast<ProfilerPhase>(phase)),
+					NK_TEXT_LEFT);
+			}
+			for (float percent : {50.0f, 95.0f, 99.0f}) {
+				graphicUI->uiAddElemInRow(valueWidth);
+				stream.str("");
+				if (phase == -1)
+					stream << "p" << static_cast<int>(percent);
+				else
+					stream << getPercentile(static_cast<ProfilerPhase>(phase),
+											percent);
+				graphicUI->uiText(stream.str(), NK_TEXT_RIGHT);
+			}
+			graphicUI->uiRowMultipleElem(false);
+		}
+		stream << std::setprecision(0);
+		for (int counter = 0; counter < CounterCount; counter++) {
+			graphicUI->uiRowMultipleElem(true, rowHeight, 4);
+			graphicUI->uiAddElemInRow(nameWidth);
+			graphicUI->uiText(
+				getCounterName(static_cast<ProfilerCounter>(counter)),
+				NK_TEXT_LEFT);
+			for (float percent : {50.0f, 95.0f, 99.0f}) {
+				graphicUI->uiAddElemInRow(valueWidth);
+				stream.str("");
+				stream << getCounterPercentile(
+					static_cast<ProfilerCounter>(counter), percent);
+				graphicUI->uiText(stream.str(), NK_TEXT_RIGHT);
+			}
+			graphicUI->uiRowMultipleElem(false);
+		}
+	}
+	graphicUI->uiEndBlock();
+}
+
+bool Profiler::dumpCSV(std::string const &path) const {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		std::cerr << "\033[0;33m:Warning:\033[0m Cannot write profiler samples "
+					 "to "
+				  << path << std::endl;
+		return false;
+	}
+	file << "frame";
+	for (int phase = 0; phase <= PhaseCount; phase++)
+		file << "," << getPhaseName(static_cast<ProfilerPhase>(phase));
+	for (int counter = 0; counter < CounterCount; counter++)
+		file << "," << getCounterName(static_cast<ProfilerCounter>(counter));
+	file << std::endl;
+	for (size_t idx = 0; idx < _sampleCount; idx++) {
+		Sample const &sample = _getSample(idx);
+		file << sample.frame;
+		for (int phase = 0; phase <= PhaseCount; phase++)
+			file << "," << sample.phases[phase];
+		for (int counter = 0; counter < CounterCount; counter++)
+			file << "," << sample.counters[counter];
+		file << std::endl;
+	}
+	return true;
+}
+
+const char *Profiler::getPhaseName(ProfilerPhase phase) {
+	static const char *names[PhaseCount + 1] = {
+		"input", "camera", "entities", "merge", "move", "destroy",
+		"initial_collisions", "animation", "shadow", "main", "gui", "frame"};
+	return names[phase];
+}
+
+const char *Profiler::getCounterName(ProfilerCounter counter) {
+	static const char *names[CounterCount] = {
+		"state_issued", "state_skipped", "culled_shadow",
+		"culled_lit",   "gpu_us",        "render_scale_pct"};
+	return names[counter];
+}
+
+Profiler::Sample const &Profiler::_getSample(size_t idx) const {
+	return _samples[(_nextSample + _samples.size() - _sampleCount + idx) %
+					_samples.size()];
+}
+
+float Profiler::_getPercentile(std::vector<float> &values, float percent) {
+	if (values.empty()) return 0.0f;
+	// Nearest rank
+	size_t rank = static_cast<size_t>(ceil(percent / 100.0f * values.size()));
+	rank = std::min(std::max<size_t>(rank, 1), values.size()) - 1;
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
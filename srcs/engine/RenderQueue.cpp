@@ -0,0 +1,97 @@
+#include "engine/RenderQueue.hpp"
+#include "engine/Entity.hpp"
+#include "engine/Model.hpp"
+
+#include <algorithm>
+
+// Key layout, from the most significant bit:
+// pass (2) | rigged (1) | program (8) | texture (16) | mesh (21) | depth (16)
+// pass (2) | rigged (1) | entity (32) | program (8) | mesh index (21)
+#define KEY_PASS_SHIFT 62
+#define KEY_RIGGED_SHIFT 61
+#define KEY_PROGRAM_SHIFT 53
+#define KEY_TEXTURE_SHIFT 37
+#define KEY_MESH_SHIFT 16
+#define KEY_ENTITY_SHIFT 29
+#define KEY_RIGGED_PROGRAM_SHIFT 21
+
+RenderQueue::RenderQueue(void) {}
+
+RenderQueue::~RenderQueue(void) {}
+
+void RenderQueue::clear(void) { _items.clear(); }
+
+void RenderQueue::add(RenderPass pass, ShaderVariants const &variants,
+					  Entity *entity, Model *model,
+					  InstanceData const &instance, float depth) {
+	DrawItem item;
+	item.entity = entity;
+	item.model = model;
+	item.instance = instance;
+	std::vector<Mesh *> const &meshes = model->getMeshes();
+	for (size_t idx = 0; idx < meshes.size(); idx++) {
+		if (meshes[idx] == nullptr) continue;
+		item.mesh = meshes[idx];
+		GLuint texture = item.mesh->getDiffuseTexture();
+		unsigned int features = 0;
+		if (model->isRigged()) features |= FeatureRigged;
+		if (texture != 0) features |= FeatureTextured;
+		item.program = variants.get(features);
+		GLuint program = item.program->getID();
+		if (model->isRigged())
+			item.key = _makeRiggedKey(pass, program, entity->getId(), idx);
+		else
+			item.key =
+				_makeKey(pass, program, texture, item.mesh->getId(), depth);
+		_items.push_back(item);
+	}
+}
+
+void RenderQueue::sort(void) {
+	std::sort(_items.begin(), _items.end(),
+			  [](DrawItem const &lhs, DrawItem const &rhs) {
+				  return lhs.key < rhs.key;
+			  });
+}
+
+void RenderQueue::getPassRange(RenderPass pass, size_t &begin,
+							   size_t &end) const {
+	auto compare = [](DrawItem const &item, uint64_t key) {
+		return item.key < key;
+	};
+	uint64_t first = static_cast<uint64_t>(pass) << KEY_PASS_SHIFT;
+	begin = std::lower_bound(_items.begin(), _items.end(), first, compare) -
+			_items.begin();
+	if (pass + 1 == PassCount) {
+		end = _items.size();
+		return;
+	}
+	uint64_t last = static_cast<uint64_t>(pass + 1) << KEY_PASS_SHIFT;
+	end = std::lower_bound(_items.begin() + begin, _items.end(), last,
+						   compare) -
+		  _items.begin();
+}
+
+std::vector<DrawItem> const &RenderQueue::getItems(void) const {
+	return _items;
+}
+
+uint64_t RenderQueue::_makeKey(RenderPass pass, GLuint program,
+							   GLuint texture, size_t meshId, float depth) {
+	float normalizedDepth =
+		std::min(std::max(depth / RENDER_QUEUE_MAX_DEPTH, 0.0f), 1.0f);
+	return (static_cast<uint64_t>(pass) << KEY_PASS_SHIFT) |
+		   (static_cast<uint64_t>(program & 0xFF) << KEY_PROGRAM_SHIFT) |
+		   (static_cast<uint64_t>(texture & 0xFFFF) << KEY_TEXTURE_SHIFT) |
+		   (static_cast<uint64_t>(meshId & 0x1FFFFF) << KEY_MESH_SHIFT) |
+		   static_cast<uint64_t>(normalizedDepth * 0xFFFF);
+}
+
+uint64_t RenderQueue::_makeRiggedKey(RenderPass pass, GLuint program,
+									 size_t entityId, size_t meshIdx) {
+	return (static_cast<uint64_t>(pass) << KEY_PASS_SHIFT) |
+		   (static_cast<uint64_t>(1) << KEY_RIGGED_SHIFT) |
+		   (static_cast<uint64_t>(entityId & 0xFFFFFFFF) << KEY_ENTITY_SHIFT) |
+		   (static_cast<uint64_t>(program & 0xFF) << KEY_RIGGED_PROGRAM_SHIFT) |
+		   static_cast<uint64_t>(meshIdx & 0x1FFFFF);
+}
@@ -1,7 +1,8 @@
 #include "engine/ShaderProgram.hpp"
 
 ShaderProgram::ShaderProgram(std::string const& vertexPath,
-							 std::string const& fragmentPath) {
+							 std::string const& fragmentPath,
+							 std::vector<std::string> const& defines) {
 	std::string vertexCode;
 	std::string fragmentCode;
 	std::ifstream vShaderFile;
@@ -16,8 +17,8 @@ ShaderProgram::ShaderProgram(std::string const& vertexPath,
 		fShaderStream << fShaderFile.rdbuf();
 		vShaderFile.close();
 		fShaderFile.close();
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
+		vertexCode = _addDefines(vShaderStream.str(), defines);
+		fragmentCode = _addDefines(fShaderStream.str(), defines);
 	} catch (const std::ifstream::failure& err) {
 		throw(std::runtime_error("Could not read the file " + vertexPath +
 								 " or " + fragmentPath + "."));
@@ -40,6 +41,9 @@ ShaderProgram::ShaderProgram(std::string const& vertexPath,
 	glAttachShader(_ID, _fs);
 	glLinkProgram(_ID);
 	_checkCompileErrors(_ID, "PROGRAM");
+	_reflectUniforms();
+	_bindUniformBlock("Frame", FRAME_BLOCK_BINDING);
+	_bindUniformBlock("Material", MATERIAL_BLOCK_BINDING);
 }
 
 ShaderProgram::~ShaderProgram(void) {
@@ -50,6 +54,18 @@ ShaderProgram::~ShaderProgram(void) {
 	glDeleteProgram(_ID);
 }
 
+std::string ShaderProgram::_addDefines(
+	std::string const& code, std::vector<std::string> const& defines) {
+	if (defines.empty()) return code;
+	// #version has to stay the first statement
+	size_t lineEnd = code.find('\n');
+	if (lineEnd == std::string::npos) lineEnd = code.size();
+	std::string result = code.substr(0, lineEnd) + "\n";
+	for (auto const& define : defines) result += "#define " + define + "\n";
+	if (lineEnd < code.size()) result += code.substr(lineEnd + 1);
+	return result;
+}
+
 void ShaderProgram::_checkCompileErrors(unsigned int shader, std::string type) {
 	int success;
 	char infoLog[1024];
@@ -78,28 +94,99 @@ void ShaderProgram::_checkCompileErrors(unsigned int shader, std::string type) {
 	}
 }
 
+void ShaderProgram::_reflectUniforms(void) {
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(_ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+
+	_uniforms.clear();
+	for (GLint idx = 0; idx < uniformCount; idx++) {
+		UniformHandle handle;
+		GLsizei nameLength = 0;
+		glGetActiveUniform(_ID, idx, nameBuffer.size(), &nameLength,
+						   &handle.size, &handle.type, &nameBuffer.front());
+		std::string name(&nameBuffer.front(), nameLength);
+		handle.location = glGetUniformLocation(_ID, name.c_str());
+		_uniforms[name] = handle;
+		// Arrays are reported as "name[0]"
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+			_uniforms[name.substr(0, name.size() - 3)] = handle;
+	}
+
+	_drawUniforms.boneTransforms = getUniform("boneTransforms");
+	_drawUniforms.cascadeIdx = getUniform("cascadeIdx");
+}
+
+void ShaderProgram::_bindUniformBlock(std::string const& name,
+									  GLuint binding) {
+	// Blocks unused by this program are simply not there
+	GLuint blockIndex = glGetUniformBlockIndex(_ID, name.c_str());
+	if (blockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(_ID, blockIndex, binding);
+}
+
+UniformHandle ShaderProgram::getUniform(std::string const& name) const {
+	auto it = _uniforms.find(name);
+	if (it == _uniforms.end()) return UniformHandle();
+	return it->second;
+}
+
+DrawUniforms const& ShaderProgram::getDrawUniforms(void) const {
+	return _drawUniforms;
+}
+
 void ShaderProgram::setBool(const std::string& name, bool value) const {
-	glUniform1i(glGetUniformLocation(_ID, name.c_str()), (int)value);
+	setBool(getUniform(name), value);
 }
 
 void ShaderProgram::setInt(const std::string& name, int value) const {
-	glUniform1i(glGetUniformLocation(_ID, name.c_str()), value);
+	setInt(getUniform(name), value);
 }
 
 void ShaderProgram::setFloat(const std::string& name, float value) const {
-	glUniform1f(glGetUniformLocation(_ID, name.c_str()), value);
+	setFloat(getUniform(name), value);
 }
 
 void ShaderProgram::setVec3(const std::string& name,
 							glm::vec3 const& value) const {
-	glUniform3fv(glGetUniformLocation(_ID, name.c_str()), 1,
-				 glm::value_ptr(value));
+	setVec3(getUniform(name), value);
 }
 
 void ShaderProgram::setMat4(const std::string& name,
 							glm::mat4 const& value) const {
-	glUniformMatrix4fv(glGetUniformLocation(_ID, name.c_str()), 1, GL_FALSE,
-					   glm::value_ptr(value));
+	setMat4(getUniform(name), value);
+}
+
+void ShaderProgram::setBool(UniformHandle const& handle, bool value) const {
+	glUniform1i(handle.location, (int)value);
+}
+
+void ShaderProgram::setInt(UniformHandle const& handle, int value) const {
+	glUniform1i(handle.location, value);
+}
+
+void ShaderProgram::setFloat(UniformHandle const& handle, float value) const {
+	glUniform1f(handle.location, value);
+}
+
+void ShaderProgram::setVec3(UniformHandle const& handle,
+							glm::vec3 const& value) const {
+	glUniform3fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void ShaderProgram::setMat4(UniformHandle const& handle,
+							glm::mat4 const& value) const {
+	glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void ShaderProgram::setMat4Array(UniformHandle const& handle,
+								 glm::mat4 const* values, size_t count) const {
+	if (handle.location == -1 || count == 0) return;
+	count = std::min(count, static_cast<size_t>(handle.size));
+	glUniformMatrix4fv(handle.location, count, GL_FALSE,
+					   glm::value_ptr(values[0]));
 }
 
 unsigned int ShaderProgram::getID(void) const { return _ID; }
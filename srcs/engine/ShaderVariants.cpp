@@ -0,0 +1,43 @@
+#include "engine/ShaderVariants.hpp"
+
+ShaderVariants::ShaderVariants(std::string const &vertexPath,
+							   std::string const &fragmentPath,
+							   unsigned int featureMask,
+							   std::vector<std::string> const &defines)
+	: _featureMask(featureMask & FeatureAll),
+	  _programs(FeatureAll + 1, nullptr) {
+	static const std::pair<ShaderFeature, const char *> featureDefines[] = {
+		{FeatureRigged, "RIGGED"}, {FeatureTextured, "TEXTURED"}};
+
+	for (unsigned int features = 0; features <= FeatureAll; features++) {
+		// Only subsets of the mask are compiled
+		if ((features & _featureMask) != features) continue;
+		std::vector<std::string> variantDefines = defines;
+		for (auto const &featureDefine : featureDefines) {
+			if (features & featureDefine.first)
+				variantDefines.push_back(featureDefine.second);
+		}
+		_programs[features] =
+			new ShaderProgram(vertexPath, fragmentPath, variantDefines);
+	}
+}
+
+ShaderVariants::~ShaderVariants(void) {
+	for (auto program : _programs) delete program;
+}
+
+ShaderProgram *ShaderVariants::get(unsigned int features) const {
+	return _programs[features & _featureMask];
+}
+
+std::vector<ShaderProgram *> const &ShaderVariants::getPrograms(void) const {
+	return _programs;
+}
+
+void ShaderVariants::setInt(std::string const &name, int value) const {
+	for (auto program : _programs) {
+		if (program == nullptr) continue;
+		glUseProgram(program->getID());
+		program->setInt(name, value);
+	}
+}
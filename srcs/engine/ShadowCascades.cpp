@@ -0,0 +1,154 @@
+#include "engine/ShadowCascades.hpp"
+
+#include <algorithm>
+#include <limits>
+
+ShadowCascades::ShadowCascades(void) {}
+
+ShadowCascades::~ShadowCascades(void) {}
+
+bool ShadowCascades::update(glm::mat4 const &lightView,
+							glm::mat4 const &cameraView,
+							glm::mat4 const &cameraProjection,
+							glm::vec3 const &sceneMin,
+							glm::vec3 const &sceneMax, size_t count,
+							bool forceFit) {
+	count = std::min<size_t>(std::max<size_t>(count, 1), MAX_SHADOW_CASCADES);
+	if (count != _count) forceFit = true;
+	_count = count;
+
+	glm::vec3 sceneCorners[8];
+	for (size_t idx = 0; idx < 8; idx++)
+		sceneCorners[idx] = glm::vec3(idx & 1 ? sceneMax.x : sceneMin.x,
+									  idx & 2 ? sceneMax.y : sceneMin.y,
+									  idx & 4 ? sceneMax.z : sceneMin.z);
+
+	// Camera frustum corners in view space, on the near and far planes
+	glm::mat4 inverseProjection = glm::inverse(cameraProjection);
+	glm::vec3 nearCorners[4];
+	glm::vec3 farCorners[4];
+	for (size_t idx = 0; idx < 4; idx++) {
+		float x = idx & 1 ? 1.0f : -1.0f;
+		float y = idx & 2 ? 1.0f : -1.0f;
+		glm::vec4 corner = inverseProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		nearCorners[idx] = glm::vec3(corner) / corner.w;
+		corner = inverseProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		farCorners[idx] = glm::vec3(corner) / corner.w;
+	}
+	float cameraNear = -nearCorners[0].z;
+	float cameraFar = -farCorners[0].z;
+
+	// Only split the part of the view where there is something to shadow
+	float near = cameraFar;
+	float far = cameraNear;
+	for (auto const &corner : sceneCorners) {
+		float depth = -(cameraView * glm::vec4(corner, 1.0f)).z;
+		near = std::min(near, depth);
+		far = std::max(far, depth);
+	}
+	near = std::max(near, cameraNear);
+	far = std::min(far, cameraFar);
+	if (far <= near) {
+		near = cameraNear;
+		far = cameraFar;
+	}
+
+	// Scene depth range seen from the light
+	glm::vec3 lightMin(std::numeric_limits<float>::max());
+	glm::vec3 lightMax(-std::numeric_limits<float>::max());
+	for (auto const &corner : sceneCorners) {
+		glm::vec3 position = glm::vec3(lightView * glm::vec4(corner, 1.0f));
+		lightMin = glm::min(lightMin, position);
+		lightMax = glm::max(lightMax, position);
+	}
+
+	glm::mat4 inverseView = glm::inverse(cameraView);
+	bool hasChanged = false;
+	float sliceStart = near;
+	for (size_t cascadeIdx = 0; cascadeIdx < _count; cascadeIdx++) {
+		Cascade &cascade = _cascades[cascadeIdx];
+		float ratio = static_cast<float>(cascadeIdx + 1) / _count;
+		float uniformSplit = near + (far - near) * ratio;
+		float logSplit = near * std::pow(far / near, ratio);
+		cascade.split =
+			glm::mix(uniformSplit, logSplit, SHADOW_CASCADE_LAMBDA);
+
+		// World box of the slice, clipped to the scene
+		glm::vec3 sliceMin(std::numeric_limits<float>::max());
+		glm::vec3 sliceMax(-std::numeric_limits<float>::max());
+		for (float depth : {sliceStart, cascade.split}) {
+			float t = (depth - cameraNear) / (cameraFar - cameraNear);
+			for (size_t idx = 0; idx < 4; idx++) {
+				glm::vec3 corner =
+					glm::mix(nearCorners[idx], farCorners[idx], t);
+				corner = glm::vec3(inverseView * glm::vec4(corner, 1.0f));
+				sliceMin = glm::min(sliceMin, corner);
+				sliceMax = glm::max(sliceMax, corner);
+			}
+		}
+		sliceMin = glm::max(sliceMin, sceneMin);
+		sliceMax = glm::min(sliceMax, sceneMax);
+		if (sliceMin.x > sliceMax.x || sliceMin.y > sliceMax.y ||
+			sliceMin.z > sliceMax.z) {
+			sliceMin = sceneMin;
+			sliceMax = sceneMax;
+		}
+		sliceStart = cascade.split;
+
+		glm::vec3 needMin(std::numeric_limits<float>::max());
+		glm::vec3 needMax(-std::numeric_limits<float>::max());
+		for (size_t idx = 0; idx < 8; idx++) {
+			glm::vec3 corner(idx & 1 ? sliceMax.x : sliceMin.x,
+							 idx & 2 ? sliceMax.y : sliceMin.y,
+							 idx & 4 ? sliceMax.z : sliceMin.z);
+			glm::vec3 position =
+				glm::vec3(lightView * glm::vec4(corner, 1.0f));
+			needMin = glm::min(needMin, position);
+			needMax = glm::max(needMax, position);
+		}
+		needMin.z = lightMin.z;
+		needMax.z = lightMax.z;
+		if (_fit(cascade, lightView, needMin, needMax, forceFit))
+			hasChanged = true;
+	}
+	return hasChanged;
+}
+
+size_t ShadowCascades::getCount(void) const { return _count; }
+
+glm::mat4 const &ShadowCascades::getMatrix(size_t idx) const {
+	return _cascades[idx].matrix;
+}
+
+float ShadowCascades::getSplit(size_t idx) const {
+	return _cascades[idx].split;
+}
+
+bool ShadowCascades::_fit(Cascade &cascade, glm::mat4 const &lightView,
+						  glm::vec3 const &needMin, glm::vec3 const &needMax,
+						  bool forceFit) {
+	// Keep at least one unit per side, an empty scene gives a flat box
+	glm::vec3 center = (needMin + needMax) * 0.5f;
+	glm::vec3 halfSize =
+		glm::max((needMax - needMin) * 0.5f, glm::vec3(0.5f));
+	glm::vec3 boxMin = center - halfSize;
+	glm::vec3 boxMax = center + halfSize;
+
+	bool doesHold = boxMin.x >= cascade.min.x && boxMin.y >= cascade.min.y &&
+					boxMin.z >= cascade.min.z && boxMax.x <= cascade.max.x &&
+					boxMax.y <= cascade.max.y && boxMax.z <= cascade.max.z;
+	float fittedArea =
+		(cascade.max.x - cascade.min.x) * (cascade.max.y - cascade.min.y);
+	float neededArea = 4.0f * halfSize.x * halfSize.y;
+	if (!forceFit && doesHold && fittedArea <= neededArea * SHADOW_FIT_SLACK)
+		return false;
+
+	glm::vec3 margin = halfSize * 2.0f * SHADOW_FIT_MARGIN;
+	cascade.min = boxMin - margin;
+	cascade.max = boxMax + margin;
+	// The light looks down its -z axis
+	cascade.matrix = glm::ortho(cascade.min.x, cascade.max.x, cascade.min.y,
+								cascade.max.y, -cascade.max.z, -cascade.min.z) *
+					 lightView;
+	return true;
+}
@@ -0,0 +1,119 @@
+#include "engine/SpatialGrid.hpp"
+
+SpatialGrid::SpatialGrid(float cellSize)
+	: _cellSize(cellSize), _queryStamp(0) {}
+
+SpatialGrid::~SpatialGrid(void) {}
+
+void SpatialGrid::insert(Entity *entity) {
+	if (entity->getCollider() == nullptr) return;
+	auto it = _records.find(entity->getId());
+	if (it != _records.end()) _unlink(&it->second);
+	Record &record = _records[entity->getId()];
+	record.entity = entity;
+	record.range = _getCellRange(entity);
+	record.queryStamp = _queryStamp;
+	_link(&record);
+}
+
+void SpatialGrid::update(Entity *entity) {
+	auto it = _records.find(entity->getId());
+	if (it == _records.end() || it->second.entity != entity) return;
+	Record &record = it->second;
+	CellRange range = _getCellRange(entity);
+	// Most moves stay inside the same cells, nothing to do then
+	if (range.minX == record.range.minX && range.minZ == record.range.minZ &&
+		range.maxX == record.range.maxX && range.maxZ == record.range.maxZ)
+		return;
+	_unlink(&record);
+	record.range = range;
+	_link(&record);
+}
+
+void SpatialGrid::remove(Entity *entity) {
+	auto it = _records.find(entity->getId());
+	if (it == _records.end() || it->second.entity != entity) return;
+	_unlink(&it->second);
+	_records.erase(it);
+}
+
+void SpatialGrid::clear(void) {
+	_cells.clear();
+	_records.clear();
+	_queryStamp = 0;
+}
+
+bool SpatialGrid::contains(Entity *entity) const {
+	auto it = _records.find(entity->getId());
+	return it != _records.end() && it->second.entity == entity;
+}
+
+size_t SpatialGrid::size(void) const { return _records.size(); }
+
+void SpatialGrid::query(float left, float top, float right, float bot,
+						std::vector<Entity *> &result, LayerMask layers) {
+	// Stamp records so that entities spanning several cells are added once
+	_queryStamp++;
+	int minX = _toCell(left);
+	int maxX = _toCell(right);
+	int minZ = _toCell(top);
+	int maxZ = _toCell(bot);
+	for (int x = minX; x <= maxX; x++) {
+		for (int z = minZ; z <= maxZ; z++) {
+			auto cell = _cells.find(_cellKey(x, z));
+			if (cell == _cells.end()) continue;
+			for (auto record : cell->second) {
+				if (record->queryStamp == _queryStamp) continue;
+				record->queryStamp = _queryStamp;
+				if (layers & layerBit(record->entity->getCollider()->layerTag))
+					result.push_back(record->entity);
+			}
+		}
+	}
+}
+
+int SpatialGrid::_toCell(float coord) const {
+	return static_cast<int>(floor(coord / _cellSize));
+}
+
+uint64_t SpatialGrid::_cellKey(int x, int z) const {
+	// Shifting a negative signed value is undefined, cells may be negative
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+		   static_cast<uint32_t>(z);
+}
+
+SpatialGrid::CellRange SpatialGrid::_getCellRange(Entity *entity) const {
+	const Collider *collider = entity->getCollider();
+	const glm::vec3 &position = entity->getPosition();
+	CellRange range;
+	range.minX = _toCell(position.x - collider->width);
+	range.maxX = _toCell(position.x + collider->width);
+	range.minZ = _toCell(position.z - collider->height);
+	range.maxZ = _toCell(position.z + collider->height);
+	return range;
+}
+
+void SpatialGrid::_link(Record *record) {
+	for (int x = record->range.minX; x <= record->range.maxX; x++) {
+		for (int z = record->range.minZ; z <= record->range.maxZ; z++) {
+			_cells[_cellKey(x, z)].push_back(record);
+		}
+	}
+}
+
+void SpatialGrid::_unlink(Record *record) {
+	for (int x = record->range.minX; x <= record->range.maxX; x++) {
+		for (int z = record->range.minZ; z <= record->range.maxZ; z++) {
+			auto cell = _cells.find(_cellKey(x, z));
+			if (cell == _cells.end()) continue;
+			std::vector<Record *> &records = cell->second;
+			for (size_t idx = 0; idx < records.size(); idx++) {
+				if (records[idx] == record) {
+					records[idx] = records.back();
+					records.pop_back();
+					break;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#include "engine/ThreadPool.hpp"
+
+ThreadPool::ThreadPool(size_t threadCount) : _threadCount(threadCount) {
+	if (_threadCount == 0) _threadCount = std::thread::hardware_concurrency();
+	_threadCount = std::max<size_t>(_threadCount, 1);
+}
+
+ThreadPool::~ThreadPool(void) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_isStopping = true;
+	}
+	_wakeCondition.notify_all();
+	for (auto &worker : _workers) worker.join();
+}
+
+size_t ThreadPool::getThreadCount(void) const { return _threadCount; }
+
+void ThreadPool::run(size_t count, std::function<void(size_t)> const &task) {
+	if (count == 0) return;
+	if (count == 1 || _threadCount == 1) {
+		for (size_t idx = 0; idx < count; idx++) task(idx);
+		return;
+	}
+	if (_workers.empty()) {
+		for (size_t idx = 1; idx < _threadCount; idx++)
+			_workers.push_back(std::thread(&ThreadPool::_work, this));
+	}
+	std::unique_lock<std::mutex> lock(_mutex);
+	_task = &task;
+	_count = count;
+	_next = 0;
+	_pending = count;
+	_wakeCondition.notify_all();
+	_runIndices(lock);
+	_doneCondition.wait(lock, [this]() { return _pending == 0; });
+	_task = nullptr;
+}
+
+void ThreadPool::_work(void) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_wakeCondition.wait(lock, [this]() {
+			return _isStopping || (_task != nullptr && _next < _count);
+		});
+		if (_isStopping) return;
+		_runIndices(lock);
+	}
+}
+
+void ThreadPool::_runIndices(std::unique_lock<std::mutex> &lock) {
+	while (_task != nullptr && _next < _count) {
+		size_t idx = _next++;
+		std::function<void(size_t)> const &task = *_task;
+		lock.unlock();
+		task(idx);
+		lock.lock();
+		if (--_pending == 0) _doneCondition.notify_all();
+	}
+}
@@ -0,0 +1,88 @@
+#include "engine/TileLayer.hpp"
+
+TileLayer::TileLayer(void) {}
+
+TileLayer::~TileLayer(void) {}
+
+bool TileLayer::isTile(Entity *entity) {
+	const Collider *collider = entity->getCollider();
+	if (collider == nullptr || !collider->isStatic || collider->isTrigger ||
+		collider->shape != Collider::Rectangle)
+		return false;
+	// Must fit inside the cell it is centered on
+	if (collider->width > TILE_SIZE / 2.0f ||
+		collider->height > TILE_SIZE / 2.0f)
+		return false;
+	const glm::vec3 &position = entity->getPosition();
+	float x = position.x / TILE_SIZE;
+	float z = position.z / TILE_SIZE;
+	return fabs(x - round(x)) <= EPSILON && fabs(z - round(z)) <= EPSILON;
+}
+
+bool TileLayer::insert(Entity *entity) {
+	if (!isTile(entity)) return false;
+	uint64_t key = _tileKey(toTile(entity->getPosition().x),
+						   toTile(entity->getPosition().z));
+	// Only one tile per cell, extra ones are handled as dynamic bodies
+	if (_tiles.find(key) != _tiles.end()) return false;
+	if (_keys.find(entity->getId()) != _keys.end()) return false;
+	_tiles[key] = entity;
+	_keys[entity->getId()] = key;
+	return true;
+}
+
+void TileLayer::remove(Entity *entity) {
+	auto it = _keys.find(entity->getId());
+	if (it == _keys.end()) return;
+	auto tile = _tiles.find(it->second);
+	if (tile == _tiles.end() || tile->second != entity) return;
+	_tiles.erase(tile);
+	_keys.erase(it);
+}
+
+void TileLayer::clear(void) {
+	_tiles.clear();
+	_keys.clear();
+}
+
+bool TileLayer::contains(Entity *entity) const {
+	auto it = _keys.find(entity->getId());
+	if (it == _keys.end()) return false;
+	auto tile = _tiles.find(it->second);
+	return tile != _tiles.end() && tile->second == entity;
+}
+
+size_t TileLayer::size(void) const { return _tiles.size(); }
+
+Entity *TileLayer::getTile(int x, int z) const {
+	auto tile = _tiles.find(_tileKey(x, z));
+	return tile != _tiles.end() ? tile->second : nullptr;
+}
+
+int TileLayer::toTile(float coord) const {
+	return static_cast<int>(round(coord / TILE_SIZE));
+}
+
+void TileLayer::query(float left, float top, float right, float bot,
+					  std::vector<Entity *> &result, LayerMask layers) const {
+	// A tile never goes past half a cell around its center
+	int minX = static_cast<int>(ceil(left / TILE_SIZE - 0.5f));
+	int maxX = static_cast<int>(floor(right / TILE_SIZE + 0.5f));
+	int minZ = static_cast<int>(ceil(top / TILE_SIZE - 0.5f));
+	int maxZ = static_cast<int>(floor(bot / TILE_SIZE + 0.5f));
+	Entity *tile;
+	for (int x = minX; x <= maxX; x++) {
+		for (int z = minZ; z <= maxZ; z++) {
+			tile = getTile(x, z);
+			if (tile != nullptr &&
+				(layers & layerBit(tile->getCollider()->layerTag)))
+				result.push_back(tile);
+		}
+	}
+}
+
+uint64_t TileLayer::_tileKey(int x, int z) const {
+	// Same unsigned packing as SpatialGrid, tiles may be negative too
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+		   static_cast<uint32_t>(z);
+}
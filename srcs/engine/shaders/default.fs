@@ -4,61 +4,93 @@ out vec4 fragColor;
 in vec3 _normal;
 in vec3 _fragPos;
 in vec2 _texCoords;
-in vec4 _fragPosLightSpace;
+in float _viewDepth;
+flat in vec3 _tint;
 
-uniform vec3 lightDir;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
+layout (std140) uniform Frame {
+    mat4 VP;
+    mat4 lightSpaceMatrices[4]; // MAX_SHADOW_CASCADES
+    mat4 skyboxVP;
+    vec3 viewPos;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec4 cascadeSplits; // View depth where each cascade ends
+    int cascadeCount;
+};
+
+#ifndef PCF_RADIUS
+#define PCF_RADIUS 1 // Set from the quality tier
+#endif
 
+#ifdef TEXTURED
 uniform sampler2D diffuseTexture;
-uniform sampler2D shadowMap;
+#endif
+uniform sampler2DArray shadowMap; // One layer per cascade
 
-struct Material {
+// Bound per mesh, see MaterialBlock
+layout (std140) uniform Material {
     vec3 ambientColor;
+    float shininess;
     vec3 diffuseColor;
     vec3 specularColor;
-    bool hasDiffuseTexture;
-    float shininess;
-};
+} material;
 
-uniform Material material;
-
-float shadowCalculation(vec4 fragPosLightSpace) {
+float shadowCalculation(vec3 fragPos) {
+    // Cascades get farther from the camera
+    int cascade = 0;
+    for (int i = 0; i < cascadeCount - 1; ++i) {
+        if (_viewDepth > cascadeSplits[i])
+            cascade = i + 1;
+    }
+    vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(fragPos, 1.0f);
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
 
     float currentDepth = projCoords.z;
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    vec2 texelSize = 1.0 / textureSize(shadowMap, 0).xy;
     
-    for(int x = -1; x <= 1; ++x) {
-        for(int y = -1; y <= 1; ++y) {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r; 
-            shadow += currentDepth > pcfDepth ? 0.75f : 0.0f;        
+    // Kernel size depends on the quality tier
+    for(int x = -PCF_RADIUS; x <= PCF_RADIUS; ++x) {
+        for(int y = -PCF_RADIUS; y <= PCF_RADIUS; ++y) {
+            float pcfDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, cascade)).r; 
+            shadow += currentDepth > pcfDepth ? 1.0f : 0.0f;        
         }    
     }
-    shadow /= 10.0f;
+    float taps = float((2 * PCF_RADIUS + 1) * (2 * PCF_RADIUS + 1));
+    shadow *= 0.675f / taps;
     // if (projCoords.z > 1.0f)
         // shadow = 0.0f;s
     return shadow;
 }
 
 void main() {
+    // Instance tint, -1 means the material colors are kept
+    vec3 ambientColor = material.ambientColor;
+    vec3 diffuseColor = material.diffuseColor;
+    vec3 specularColor = material.specularColor;
+    if (_tint.x != -1.0f && _tint.y != -1.0f && _tint.z != -1.0f) {
+        ambientColor = mix(ambientColor, _tint, 0.5f);
+        diffuseColor = mix(diffuseColor, _tint, 0.5f);
+        specularColor = mix(specularColor, _tint, 0.5f);
+    }
+
     // Ambient
-    vec3 ambient;
     float ambientStrength = 0.25f;
-    if (material.hasDiffuseTexture)
-        ambient = ambientStrength * texture(diffuseTexture, _texCoords).xyz * lightColor;
-    else
-        ambient = ambientStrength * material.ambientColor * lightColor;
+#ifdef TEXTURED
+    vec3 texel = texture(diffuseTexture, _texCoords).xyz;
+    vec3 ambient = ambientStrength * texel * lightColor;
+#else
+    vec3 ambient = ambientStrength * ambientColor * lightColor;
+#endif
 
     // Difuse
-    vec3 diffuse;
     float diffCoeff = max(dot(_normal, -lightDir), 0.0f);
-    if (material.hasDiffuseTexture)
-        diffuse = diffCoeff * texture(diffuseTexture, _texCoords).xyz * material.diffuseColor * lightColor;
-    else
-        diffuse = diffCoeff * material.diffuseColor * lightColor;
+#ifdef TEXTURED
+    vec3 diffuse = diffCoeff * texel * diffuseColor * lightColor;
+#else
+    vec3 diffuse = diffCoeff * diffuseColor * lightColor;
+#endif
 
     // Specular
     vec3 specular = vec3(0.0f);
@@ -70,11 +102,11 @@ void main() {
         // // Phong model
         // vec3 reflectDir = reflect(lightDir, _normal);
         // float specularCoeff = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-        specular = specularCoeff * material.specularColor * lightColor;
+        specular = specularCoeff * specularColor * lightColor;
     }
 
     // Shadow
-    float shadow = shadowCalculation(_fragPosLightSpace);
+    float shadow = shadowCalculation(_fragPos);
     vec3 result = (ambient + (1.0 - shadow) * (diffuse + specular));
 
     fragColor = vec4(result , 1.0f);
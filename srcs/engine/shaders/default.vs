@@ -2,36 +2,49 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 texCoords;
+#ifdef RIGGED
 layout (location = 3) in ivec4 jointIds;
 layout (location = 4) in vec4 weights;
+#endif
+layout (location = 5) in mat4 M; // Per instance, uses locations 5 to 8
+layout (location = 9) in vec3 tint;
 
 out vec3 _normal;
 out vec3 _fragPos;
 out vec2 _texCoords;
-out vec4 _fragPosLightSpace;
+out float _viewDepth;
+flat out vec3 _tint;
 
-uniform mat4 M;
-uniform mat4 VP;
-uniform mat4 lightSpaceMatrix;
+layout (std140) uniform Frame {
+    mat4 VP;
+    mat4 lightSpaceMatrices[4]; // MAX_SHADOW_CASCADES
+    mat4 skyboxVP;
+    vec3 viewPos;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec4 cascadeSplits; // View depth where each cascade ends
+    int cascadeCount;
+};
+#ifdef RIGGED
 uniform mat4 boneTransforms[32];
-uniform bool rigged;
+#endif
 
 void main()
 {
-    if (rigged) {
-        mat4 jointTransform = boneTransforms[jointIds[0]] * weights[0];
-            jointTransform += boneTransforms[jointIds[1]] * weights[1];
-            jointTransform += boneTransforms[jointIds[2]] * weights[2];
-            jointTransform += boneTransforms[jointIds[3]] * weights[3];
-        gl_Position = VP * M * jointTransform * vec4(position, 1.0f);
-        _normal = normalize(M * jointTransform * vec4(normal, 0.0f)).xyz;
-        _fragPos = vec3(M * jointTransform * vec4(position, 1.0f));
-    } else {
-        gl_Position = VP * M * vec4(position, 1.0f);
-        _normal = normalize(M * vec4(normal, 0.0f)).xyz;
-        _fragPos = vec3(M * vec4(position, 1.0f));
-    }
+#ifdef RIGGED
+    mat4 jointTransform = boneTransforms[jointIds[0]] * weights[0];
+        jointTransform += boneTransforms[jointIds[1]] * weights[1];
+        jointTransform += boneTransforms[jointIds[2]] * weights[2];
+        jointTransform += boneTransforms[jointIds[3]] * weights[3];
+    mat4 model = M * jointTransform;
+#else
+    mat4 model = M;
+#endif
+    gl_Position = VP * model * vec4(position, 1.0f);
+    _normal = normalize(model * vec4(normal, 0.0f)).xyz;
+    _fragPos = vec3(model * vec4(position, 1.0f));
     // Look up transpose(inverse(M)), this works now but it won't always do
     _texCoords = texCoords;
-    _fragPosLightSpace = lightSpaceMatrix * vec4(_fragPos, 1.0f);
+    _tint = tint;
+    _viewDepth = gl_Position.w;
 }
\ No newline at end of file
@@ -1,21 +1,36 @@
 #version 410 core
 layout (location = 0) in vec3 position;
+#ifdef RIGGED
 layout (location = 3) in ivec4 jointIds;
 layout (location = 4) in vec4 weights;
+#endif
+layout (location = 5) in mat4 M; // Per instance, uses locations 5 to 8
 
-uniform mat4 lightSpaceMatrix;
-uniform mat4 M;
+layout (std140) uniform Frame {
+    mat4 VP;
+    mat4 lightSpaceMatrices[4]; // MAX_SHADOW_CASCADES
+    mat4 skyboxVP;
+    vec3 viewPos;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec4 cascadeSplits; // View depth where each cascade ends
+    int cascadeCount;
+};
+#ifdef RIGGED
 uniform mat4 boneTransforms[32];
-uniform bool rigged;
+#endif
+uniform int cascadeIdx;
 
+// Position only unless RIGGED
 void main()
 {
-    if (rigged) {
-        mat4 jointTransform = boneTransforms[jointIds[0]] * weights[0];
-            jointTransform += boneTransforms[jointIds[1]] * weights[1];
-            jointTransform += boneTransforms[jointIds[2]] * weights[2];
-            jointTransform += boneTransforms[jointIds[3]] * weights[3];
-        gl_Position = lightSpaceMatrix * M * jointTransform * vec4(position, 1.0);
-    } else
-        gl_Position = lightSpaceMatrix * M * vec4(position, 1.0);
+#ifdef RIGGED
+    mat4 jointTransform = boneTransforms[jointIds[0]] * weights[0];
+        jointTransform += boneTransforms[jointIds[1]] * weights[1];
+        jointTransform += boneTransforms[jointIds[2]] * weights[2];
+        jointTransform += boneTransforms[jointIds[3]] * weights[3];
+    gl_Position = lightSpaceMatrices[cascadeIdx] * M * jointTransform * vec4(position, 1.0);
+#else
+    gl_Position = lightSpaceMatrices[cascadeIdx] * M * vec4(position, 1.0);
+#endif
 }  
\ No newline at end of file
@@ -3,12 +3,20 @@ layout (location = 0) in vec3 position;
 
 out vec3 texCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform Frame {
+    mat4 VP;
+    mat4 lightSpaceMatrices[4]; // MAX_SHADOW_CASCADES
+    mat4 skyboxVP;
+    vec3 viewPos;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec4 cascadeSplits; // View depth where each cascade ends
+    int cascadeCount;
+};
 
 void main()
 {
     texCoords = position;
-    vec4 position = projection * view * vec4(position, 1.0);
+    vec4 position = skyboxVP * vec4(position, 1.0);
     gl_Position = position.xyww;
 }  
\ No newline at end of file
@@ -17,57 +17,64 @@
 
 extern std::string _assetsDir;
 
-Bomberman::Bomberman(void) : AGame(14), _startLevelName("MainMenu") {
+// Layers that never collide with each other, any other pair does
+static constexpr LayerPair noCollisionPairs[] = {
+	{WallLayer, WallLayer},
+	{WallLayer, BoxLayer},
+	{WallLayer, ExplosionLayer},
+	{WallLayer, PerkLayer},
+
+	{PlayerLayer, EnemySpecialLayer},
+
+	{PlayerSpecialLayer, ExplosionLayer},
+	{PlayerSpecialLayer, EnemyMeleeLayer},
+	{PlayerSpecialLayer, EnemyLayer},
+	{PlayerSpecialLayer, EnemySpecialLayer},
+	{PlayerSpecialLayer, EnemyBasicLayer},
+	{PlayerSpecialLayer, EnemyRunAwayLayer},
+
+	{EnemyRunAwayLayer, EnemyRunAwayLayer},
+	{EnemyBomberLayer, EnemyBomberLayer},
+	{EnemyBomberLayer, EnemyBasicLayer},
+	{EnemyRunAwayLayer, EnemySpecialLayer},
+	{EnemyRunAwayLayer, EnemyLayer},
+
+	{EnemySpecialLayer, EnemySpecialLayer},
+	{EnemySpecialLayer, ExplosionLayer},
+
+	{EnemyBasicLayer, EnemyBasicLayer},
+	{EnemyRunAwayLayer, EnemyBasicLayer},
+	{EnemyMeleeLayer, EnemyMeleeLayer},
+
+	{PerkLayer, PerkLayer},
+	{PerkLayer, BoxLayer},
+	{PerkLayer, ExplosionLayer},
+	{PerkLayer, BombLayer},
+
+	{PortalLayer, WallLayer},
+	{PortalLayer, BoxLayer},
+	{PortalLayer, PlayerSpecialLayer},
+	{PortalLayer, EnemyRunAwayLayer},
+	{PortalLayer, EnemyLayer},
+	{PortalLayer, EnemySpecialLayer},
+	{PortalLayer, BombLayer},
+	{PortalLayer, ExplosionLayer},
+	{PortalLayer, EnemyBomberLayer},
+	{PortalLayer, PerkLayer},
+	{PortalLayer, PortalLayer},
+	{PortalLayer, EnemyMeleeLayer}};
+
+static constexpr LayerCollisionTable<LayerCount> collisionTable =
+	buildLayerCollisionTable<LayerCount>(noCollisionPairs);
+
+Bomberman::Bomberman(void) : AGame(LayerCount), _startLevelName("MainMenu") {
 	// Set needed fonts
 	for (float size = 12.0f; size <= 48.0f; size += 1.0f)
 		_neededFonts.push_back(std::tuple<float, std::string, std::string>(
 			size, (_assetsDir + "GUI/Fonts/slider.ttf"), "slider"));
 
 	// Set collision table
-	setLayerCollision(WallLayer, WallLayer, false);
-	setLayerCollision(WallLayer, BoxLayer, false);
-	setLayerCollision(WallLayer, ExplosionLayer, false);
-	setLayerCollision(WallLayer, PerkLayer, false);
-
-	setLayerCollision(PlayerLayer, EnemySpecialLayer, false);
-
-	setLayerCollision(PlayerSpecialLayer, ExplosionLayer, false);
-	setLayerCollision(PlayerSpecialLayer, EnemyMeleeLayer, false);
-	setLayerCollision(PlayerSpecialLayer, EnemyLayer, false);
-	setLayerCollision(PlayerSpecialLayer, EnemySpecialLayer, false);
-	setLayerCollision(PlayerSpecialLayer, EnemyBasicLayer, false);
-	setLayerCollision(PlayerSpecialLayer, EnemyRunAwayLayer, false);
-
-	setLayerCollision(EnemyRunAwayLayer, EnemyRunAwayLayer, false);
-	setLayerCollision(EnemyBomberLayer, EnemyBomberLayer, false);
-	setLayerCollision(EnemyBomberLayer, EnemyBasicLayer, false);
-	setLayerCollision(EnemyRunAwayLayer, EnemySpecialLayer, false);
-	setLayerCollision(EnemyRunAwayLayer, EnemyLayer, false);
-
-	setLayerCollision(EnemySpecialLayer, EnemySpecialLayer, false);
-	setLayerCollision(EnemySpecialLayer, ExplosionLayer, false);
-
-	setLayerCollision(EnemyBasicLayer, EnemyBasicLayer, false);
-	setLayerCollision(EnemyRunAwayLayer, EnemyBasicLayer, false);
-	setLayerCollision(EnemyMeleeLayer, EnemyMeleeLayer, false);
-
-	setLayerCollision(PerkLayer, PerkLayer, false);
-	setLayerCollision(PerkLayer, BoxLayer, false);
-	setLayerCollision(PerkLayer, ExplosionLayer, false);
-	setLayerCollision(PerkLayer, BombLayer, false);
-
-	setLayerCollision(PortalLayer, WallLayer, false);
-	setLayerCollision(PortalLayer, BoxLayer, false);
-	setLayerCollision(PortalLayer, PlayerSpecialLayer, false);
-	setLayerCollision(PortalLayer, EnemyRunAwayLayer, false);
-	setLayerCollision(PortalLayer, EnemyLayer, false);
-	setLayerCollision(PortalLayer, EnemySpecialLayer, false);
-	setLayerCollision(PortalLayer, BombLayer, false);
-	setLayerCollision(PortalLayer, ExplosionLayer, false);
-	setLayerCollision(PortalLayer, EnemyBomberLayer, false);
-	setLayerCollision(PortalLayer, PerkLayer, false);
-	setLayerCollision(PortalLayer, PortalLayer, false);
-	setLayerCollision(PortalLayer, EnemyMeleeLayer, false);
+	setCollisionMasks(collisionTable.masks, LayerCount);
 
 	// Set all assets that will be needed by game (they wont be charged until
 	// added to _neededAssets)
@@ -87,6 +94,13 @@ int Bomberman::getStartingSoundsVolume(void) const {
 	return _save.soundsVolume;
 }
 
+RenderQuality Bomberman::getRenderQuality(void) const {
+	RenderQuality quality = std::get<1>(Save::QUALITIES[_save.qualityIdx]);
+	quality.dynamicResolution =
+		std::get<1>(Save::DYNAMIC_RESOLUTION[_save.dynamicResolution]);
+	return quality;
+}
+
 void Bomberman::loadSceneByIndex(int sceneIdx, std::atomic_int *_sceneState,
 								 bool *_checkLoadSceneIsGood) {
 	unload();
@@ -392,13 +406,15 @@ void Bomberman::_mario(void) {
 		protectedCase.push_back(std::tuple<int, int>(i, -6.0));
 		_entities.push_back(new Entity(
 			glm::vec3(i, 0.0, -6.0), glm::vec3(0.0f),
-			new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.5, 0.5),
+			new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.5, 0.5,
+						 false, true),
 			"WarpPipe", "Wall", "Wall", _camera));
 		_entities.back()->rotateY(90);
 		protectedCase.push_back(std::tuple<int, int>(i, 6.0));
 		_entities.push_back(new Entity(
 			glm::vec3(i, 0.0, 6.0), glm::vec3(0.0f),
-			new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.5, 0.5),
+			new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.5, 0.5,
+						 false, true),
 			"WarpPipe", "Wall", "Wall", _camera));
 		_entities.back()->rotateY(90);
 	}
@@ -628,14 +644,14 @@ void Bomberman::_createMap(int width, int height,
 				_entities.push_back(new Entity(
 					glm::vec3(x, 0.0, z), glm::vec3(0.0f),
 					new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.45,
-								 0.45),
+								 0.45, false, true),
 					border[rand() % border.size()], "Wall", "Wall", _camera));
 			} else if (canPutBlocks && x % 2 == 0 && z % 2 == 0 &&
 					   width % 2 == 0 && height % 2 == 0) {
 				_entities.push_back(new Entity(
 					glm::vec3(x, 0.0, z), glm::vec3(0.0f),
 					new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.5,
-								 0.5),
+								 0.5, false, true),
 					undestructibleBlock[rand() % undestructibleBlock.size()],
 					"Wall", "Wall", _camera));
 
@@ -644,7 +660,7 @@ void Bomberman::_createMap(int width, int height,
 				_entities.push_back(new Entity(
 					glm::vec3(x, 0.0, z), glm::vec3(0.0f),
 					new Collider(Collider::Rectangle, LayerTag::WallLayer, 0.5,
-								 0.5),
+								 0.5, false, true),
 					undestructibleBlock[rand() % undestructibleBlock.size()],
 					"Wall", "Wall", _camera));
 
@@ -15,7 +15,9 @@ void to_json(nlohmann::json& j, const Save& p) {
 					   {"isFullScreen", p.isFullScreen},
 					   {"resolutionsIdx", p.resolutionsIdx},
 					   {"musicVolume", p.musicVolume},
-					   {"soundsVolume", p.soundsVolume}};
+					   {"soundsVolume", p.soundsVolume},
+					   {"qualityIdx", p.qualityIdx},
+					   {"dynamicResolution", p.dynamicResolution}};
 }
 
 void from_json(const nlohmann::json& j, Save& p) {
@@ -28,6 +30,11 @@ void from_json(const nlohmann::json& j, Save& p) {
 	j.at("resolutionsIdx").get_to(p.resolutionsIdx);
 	j.at("musicVolume").get_to(p.musicVolume);
 	j.at("soundsVolume").get_to(p.soundsVolume);
+	// Missing from older saves, defaults are kept then
+	if (j.find("qualityIdx") != j.end())
+		j.at("qualityIdx").get_to(p.qualityIdx);
+	if (j.find("dynamicResolution") != j.end())
+		j.at("dynamicResolution").get_to(p.dynamicResolution);
 }
 
 const std::vector<std::tuple<std::string, size_t, size_t>> getResolutions() {
@@ -68,6 +75,26 @@ const std::vector<std::tuple<std::string, int>> getVolumeOptions() {
 const std::vector<std::tuple<std::string, int>> Save::VOLUMES =
 	getVolumeOptions();
 
+const std::vector<std::tuple<std::string, RenderQuality>> getQualities() {
+	std::vector<std::tuple<std::string, RenderQuality>> res;
+	// Shadow size, shadow cascades, PCF radius, MSAA samples, render scale
+	res.push_back(
+		std::make_tuple("Low", RenderQuality{1024, 1, 0, 0, 0.75f, false}));
+	res.push_back(
+		std::make_tuple("Medium", RenderQuality{2048, 1, 1, 2, 1.0f, false}));
+	res.push_back(
+		std::make_tuple("High", RenderQuality{2048, 2, 1, 4, 1.0f, false}));
+	res.push_back(
+		std::make_tuple("Ultra", RenderQuality{2048, 4, 2, 8, 1.0f, false}));
+	return res;
+}
+const std::vector<std::tuple<std::string, RenderQuality>> Save::QUALITIES =
+	getQualities();
+
+// Same choices as the full screen one
+const std::vector<std::tuple<std::string, bool>> Save::DYNAMIC_RESOLUTION =
+	getFullScreen();
+
 Save::Save(void) {
 	savePath = __FILE__;
 	savePath.erase(savePath.begin() + savePath.rfind("/Save.cpp") + 1,
@@ -122,6 +149,8 @@ void Save::resetSettings(void) {
 	resolutionsIdx = 1;
 	musicVolume = 5;
 	soundsVolume = 10;
+	qualityIdx = 2;
+	dynamicResolution = 0;
 }
 
 void Save::resetLevel(void) { level = 0; }
@@ -139,5 +168,6 @@ bool Save::areValuesGood(void) {
 	if (isFullScreen > 1) return false;
 	if (resolutionsIdx >= RESOLUTIONS.size()) return false;
 	if (musicVolume > 10 || soundsVolume > 10) return false;
+	if (qualityIdx >= QUALITIES.size() || dynamicResolution > 1) return false;
 	return true;
 }
@@ -247,5 +247,6 @@ void AEnemy::onDeath(void) {
 		_hasSpawned = true;
 		_toSpawn->translate(getPosition() - _toSpawn->getPosition());
 		_gameEngine->addNewEntity(_toSpawn);
+		_toSpawn = nullptr;  // Owned by the engine from now on
 	}
 }
@@ -8,7 +8,8 @@ Box::Box(glm::vec3 position, Entity *sceneManager, std::string modelName,
 		 int perkProb, Entity *toSpawn)
 	: Damageable(
 		  position, glm::vec3(0.0f),
-		  new Collider(Collider::Rectangle, LayerTag::BoxLayer, 0.45f, 0.45f),
+		  new Collider(Collider::Rectangle, LayerTag::BoxLayer, 0.45f, 0.45f,
+					   false, true),
 		  modelName, "Box", "Box", 1, BoxLayer, WallLayer, 1.0f, sceneManager),
 	  _onFire(false),
 	  _hasSpawned(false),
@@ -35,6 +36,7 @@ void Box::update(void) {
 			_hasSpawned = true;
 			_toSpawn->translate(getPosition() - _toSpawn->getPosition());
 			_gameEngine->addNewEntity(_toSpawn);
+			_toSpawn = nullptr;  // Owned by the engine from now on
 		} else if (rand() % 100 < _perkProb) {
 			_gameEngine->addNewEntity(new Perk(getPosition(), _sceneManager));
 		}
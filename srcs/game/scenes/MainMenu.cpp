@@ -241,6 +241,20 @@ void MainMenu::_settings(GUI *graphicUI) {
 			_gameEngine->updateSoundsVolume(_soundsVolume);
 			_gameEngine->playSound("lateral_select");
 		}
+		if (graphicUI->uiHorizontalSelection(
+				_gameEngine->getGameRenderer()->getWidth() / 2, "Quality",
+				std::get<0>(Save::QUALITIES[_qualityIdx]), &_qualityIdx,
+				Save::QUALITIES.size() - 1, rowHeight)) {
+			_gameEngine->playSound("lateral_select");
+		}
+		if (graphicUI->uiHorizontalSelection(
+				_gameEngine->getGameRenderer()->getWidth() / 2,
+				"Dynamic Resolution",
+				std::get<0>(Save::DYNAMIC_RESOLUTION[_dynamicResolution]),
+				&_dynamicResolution, Save::DYNAMIC_RESOLUTION.size() - 1,
+				rowHeight)) {
+			_gameEngine->playSound("lateral_select");
+		}
 		graphicUI->uiHeader("Keyboard Controls", NK_TEXT_CENTERED, 30,
 							"28_slider");
 		graphicUI->uiHorizontalEditString(
@@ -341,6 +355,8 @@ void MainMenu::_updateVarsFromSave(void) {
 	_resolutionsIdx = _save.resolutionsIdx;
 	_musicVolume = _save.musicVolume;
 	_soundsVolume = _save.soundsVolume;
+	_qualityIdx = _save.qualityIdx;
+	_dynamicResolution = _save.dynamicResolution;
 }
 
 void MainMenu::_updateSaveFromVars(void) {
@@ -352,4 +368,6 @@ void MainMenu::_updateSaveFromVars(void) {
 	_save.resolutionsIdx = _resolutionsIdx;
 	_save.musicVolume = _musicVolume;
 	_save.soundsVolume = _soundsVolume;
+	_save.qualityIdx = _qualityIdx;
+	_save.dynamicResolution = _dynamicResolution;
 }
@@ -979,7 +979,8 @@ void SceneTools::_buildNewNode(size_t dist, size_t x, size_t z, size_t pos,
 					z) {
 				for (const auto &decor : _tmpDecor) {
 					if (map.second->getName().compare(decor) == 0) {
-						tmpNode->entitiesOnMe.push_back(map.second);
+						tmpNode->entitiesOnMe.push_back(
+							_gameEngine->getEntityHandle(map.second));
 						tmpNode->isAnEntity = true;
 					}
 				}
@@ -989,7 +990,9 @@ void SceneTools::_buildNewNode(size_t dist, size_t x, size_t z, size_t pos,
 	} else {  // Save the change if the node exist
 		if (!saveInPrevious && _graphe.at(pos)->runAwayDist == 0) {
 			bool isPlayer = false;
-			for (const auto &entity : _graphe.at(pos)->entitiesOnMe) {
+			for (const auto &handle : _graphe.at(pos)->entitiesOnMe) {
+				Entity *entity = _gameEngine->getEntity(handle);
+				if (entity == nullptr) continue;  // Destroyed since
 				if (entity->getName().compare("Player") == 0) isPlayer = true;
 				for (const auto &vec : _tmpDecor) {
 					if (vec.compare(entity->getName()) == 0) isPlayer = true;
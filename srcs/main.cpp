@@ -2,13 +2,60 @@
 #include "stb_image/stb_image.h"
 #undef STB_IMAGE_IMPLEMENTATION
 
+#include "engine/AnimationBenchmark.hpp"
+#include "engine/BroadphaseBenchmark.hpp"
 #include "engine/GameEngine.hpp"
 #include "game/Bomberman.hpp"
 
 std::string _assetsDir;
 std::string _srcsDir;
 
-int main(void) {
+static void printUsage(char const *name) {
+	std::cerr << "Usage: " << name
+			  << " [--headless] [--fast-forward] [--ticks N]"
+				 " [--input-script FILE] [--scene NAME] [--profile FILE]"
+				 " [--bench-animation ASSET] [--check-animation]"
+				 " [--bench-broadphase SCENE]"
+			  << std::endl;
+}
+
+int main(int argc, char **argv) {
+	bool headless = false;
+	bool fastForward = false;
+	size_t maxTicks = 0;
+	std::string inputScriptPath;
+	std::string sceneName;
+	std::string profilePath;
+	std::string benchAssetName;
+	std::string benchSceneName;
+	bool checkAnimation = false;
+	for (int idx = 1; idx < argc; idx++) {
+		std::string arg = argv[idx];
+		bool hasValue = idx + 1 < argc;
+		if (arg == "--headless")
+			headless = true;
+		else if (arg == "--fast-forward")
+			fastForward = true;
+		else if (arg == "--ticks" && hasValue)
+			maxTicks = strtoul(argv[++idx], nullptr, 10);
+		else if (arg == "--input-script" && hasValue)
+			inputScriptPath = argv[++idx];
+		else if (arg == "--scene" && hasValue)
+			sceneName = argv[++idx];
+		else if (arg == "--profile" && hasValue)
+			profilePath = argv[++idx];
+		else if (arg == "--bench-animation" && hasValue)
+			benchAssetName = argv[++idx];
+		else if (arg == "--check-animation")
+			checkAnimation = true;
+		else if (arg == "--bench-broadphase" && hasValue)
+			benchSceneName = argv[++idx];
+		else {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
 	_srcsDir = __FILE__;
 	_srcsDir.erase(_srcsDir.begin() + _srcsDir.rfind("/srcs/") + 1,
 				   _srcsDir.end());
@@ -17,9 +64,51 @@ int main(void) {
 	try {
 		/* Initialize random seed: */
 		srand(clock());
+		// Kernels against glm on random keys, no asset nor window needed
+		if (checkAnimation)
+			return AnimationBenchmark::checkKernels() ? EXIT_SUCCESS
+													  : EXIT_FAILURE;
 		AGame *myGame = new Bomberman();
-		GameEngine gameEngine(myGame);
+		if (!benchAssetName.empty()) {
+			// Samples the poses of an asset and exits, nothing is displayed
+			myGame->initAllAssets();
+			auto asset = myGame->getAllAssets().find(benchAssetName);
+			if (asset == myGame->getAllAssets().end())
+				throw std::runtime_error(
+					"\033[0;31m:Error:\033[0m Unknown asset " +
+					benchAssetName);
+			bool isValid = AnimationBenchmark(asset->second).run();
+			delete myGame;
+			return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		if (!benchSceneName.empty()) {
+			// Simulates a scene without window, fails on any broadphase miss
+			bool isValid;
+			{
+				GameEngine gameEngine(myGame, true);
+				if (!gameEngine.setFirstScene(benchSceneName))
+					throw std::runtime_error(
+						"\033[0;31m:Error:\033[0m Unknown scene " +
+						benchSceneName);
+				if (!inputScriptPath.empty())
+					gameEngine.setInputScript(
+						GameEngine::loadInputScript(inputScriptPath));
+				isValid = BroadphaseBenchmark(gameEngine).run(
+					maxTicks != 0 ? maxTicks : BROADPHASE_BENCHMARK_TICKS);
+			}
+			delete myGame;
+			return isValid ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		GameEngine gameEngine(myGame, headless);
+		gameEngine.setFastForward(fastForward);
+		gameEngine.setMaxTicks(maxTicks);
+		if (!inputScriptPath.empty())
+			gameEngine.setInputScript(
+				GameEngine::loadInputScript(inputScriptPath));
+		if (!sceneName.empty()) gameEngine.setFirstScene(sceneName);
 		gameEngine.run();
+		if (!profilePath.empty())
+			gameEngine.getProfiler().dumpCSV(profilePath);
 		delete myGame;
 	} catch (const std::runtime_error &err) {
 		std::cerr << err.what() << std::endl;